@@ -20,6 +20,7 @@ void bidirectional_stream_copy( Socket& socket, string_view peer_name )
   ByteStream _inbound { buffer_size };
   bool _outbound_shutdown { false };
   bool _inbound_shutdown { false };
+  vector<string_view> _views {};
 
   socket.set_blocking( false );
   _input.set_blocking( false );
@@ -31,10 +32,7 @@ void bidirectional_stream_copy( Socket& socket, string_view peer_name )
     _input,
     Direction::In,
     [&] {
-      string data;
-      data.resize( _outbound.writer().available_capacity() );
-      _input.read( data );
-      _outbound.writer().push( move( data ) );
+      _input.read_into( _outbound.writer() );
       if ( _input.eof() ) {
         _outbound.writer().close();
       }
@@ -57,7 +55,8 @@ void bidirectional_stream_copy( Socket& socket, string_view peer_name )
     Direction::Out,
     [&] {
       if ( _outbound.reader().bytes_buffered() ) {
-        _outbound.reader().pop( socket.write( _outbound.reader().peek() ) );
+        _outbound.reader().peek( _views );
+        _outbound.reader().pop( socket.write( _views ) );
       }
       if ( _outbound.reader().is_finished() ) {
         socket.shutdown( SHUT_WR );
@@ -81,10 +80,7 @@ void bidirectional_stream_copy( Socket& socket, string_view peer_name )
     socket,
     Direction::In,
     [&] {
-      string data;
-      data.resize( _inbound.writer().available_capacity() );
-      socket.read( data );
-      _inbound.writer().push( move( data ) );
+      socket.read_into( _inbound.writer() );
       if ( socket.eof() ) {
         _inbound.writer().close();
       }
@@ -107,7 +103,8 @@ void bidirectional_stream_copy( Socket& socket, string_view peer_name )
     Direction::Out,
     [&] {
       if ( _inbound.reader().bytes_buffered() ) {
-        _inbound.reader().pop( _output.write( _inbound.reader().peek() ) );
+        _inbound.reader().peek( _views );
+        _inbound.reader().pop( _output.write( _views ) );
       }
       if ( _inbound.reader().is_finished() ) {
         _output.close();
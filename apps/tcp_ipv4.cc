@@ -1,4 +1,5 @@
 #include "bidirectional_stream_copy.hh"
+#include "reassembly_budget.hh"
 #include "tcp_config.hh"
 #include "tcp_minnow_socket.hh"
 #include "tun.hh"
@@ -10,6 +11,7 @@
 #include <random>
 #include <span>
 #include <string>
+#include <string_view>
 #include <tuple>
 
 using namespace std;
@@ -31,14 +33,27 @@ void show_usage( const char* argv0, const char* msg )
        << "   -s <port>       Set source port (client mode only)              (random)\n\n"
 
        << "   -w <winsz>      Use a window of <winsz> bytes                   " << TCPConfig::MAX_PAYLOAD_SIZE
-       << "\n\n"
-
-       << "   -t <tmout>      Set rt_timeout to tmout                         " << TCPConfig::TIMEOUT_DFLT << "\n\n"
+       << "\n"
+       << "   -M <mss>        Largest payload per segment                     " << TCPConfig::MAX_PAYLOAD_SIZE
+       << "\n"
+       << "   -U              Probe the path MTU, from the default up to -M   (fixed MSS)\n"
+       << "   -R              Reassemble in place in the receive window       (buffer fragments)\n"
+       << "   -B <bytes>      Cap on out-of-order bytes held, all connections (no cap)\n\n"
+
+       << "   -t <tmout>      Set rt_timeout to tmout                         " << TCPConfig::TIMEOUT_DFLT << "\n"
+       << "   -T <tmout>      Floor on the RTT-derived timeout                " << TCPConfig::MIN_TIMEOUT_DFLT << "\n"
+       << "   -C <algo>       Congestion control: none, newreno, bbr, dctcp   newreno\n"
+       << "   -E              Negotiate ECN (implied by -C dctcp)             (ECN off)\n"
+       << "   -K              Disable selective acknowledgments               (SACK on)\n"
+       << "   -N              Send small writes at once, without Nagle        (Nagle on)\n"
+       << "   -D <delay>      Delay ACKs up to <delay> ms, 0 to ACK each one  " << TCPConfig::ACK_DELAY_DFLT << "\n"
+       << "   -P <rate>       Pace sending at <rate> bytes/s, 0 for cwnd/SRTT (no pacing)\n\n"
 
        << "   -d <tundev>     Connect to tun <tundev>                         " << TUN_DFLT << "\n\n"
 
        << "   -Lu <loss>      Set uplink loss to <rate> (float in 0..1)       (no loss)\n"
-       << "   -Ld <loss>      Set downlink loss to <rate> (float in 0..1)     (no loss)\n\n"
+       << "   -Ld <loss>      Set downlink loss to <rate> (float in 0..1)     (no loss)\n"
+       << "   -Lm <mtu>       Drop outbound datagrams larger than <mtu> bytes (no limit)\n\n"
 
        << "   -h              Show this message.\n\n";
 
@@ -91,11 +106,74 @@ tuple<TCPConfig, FdAdapterConfig, bool, const char*> get_config( const span<char
       c_fsm.recv_capacity = strtol( args[curr + 1], nullptr, 0 );
       curr += 2;
 
+    } else if ( strncmp( "-M", args[curr], 3 ) == 0 ) {
+      check_argc( args, curr, "ERROR: -M requires one argument." );
+      c_fsm.mss = strtol( args[curr + 1], nullptr, 0 );
+      curr += 2;
+
+    } else if ( strncmp( "-U", args[curr], 3 ) == 0 ) {
+      c_fsm.mtu_probing = true;
+      curr += 1;
+
+    } else if ( strncmp( "-R", args[curr], 3 ) == 0 ) {
+      c_fsm.window_reassembly = true;
+      curr += 1;
+
+    } else if ( strncmp( "-B", args[curr], 3 ) == 0 ) {
+      check_argc( args, curr, "ERROR: -B requires one argument." );
+      ReassemblyBudget::global().set_limit( strtoull( args[curr + 1], nullptr, 0 ) );
+      curr += 2;
+
     } else if ( strncmp( "-t", args[curr], 3 ) == 0 ) {
       check_argc( args, curr, "ERROR: -t requires one argument." );
       c_fsm.rt_timeout = strtol( args[curr + 1], nullptr, 0 );
       curr += 2;
 
+    } else if ( strncmp( "-T", args[curr], 3 ) == 0 ) {
+      check_argc( args, curr, "ERROR: -T requires one argument." );
+      c_fsm.min_rt_timeout = strtol( args[curr + 1], nullptr, 0 );
+      curr += 2;
+
+    } else if ( strncmp( "-C", args[curr], 3 ) == 0 ) {
+      check_argc( args, curr, "ERROR: -C requires one argument." );
+      const string_view algorithm = args[curr + 1];
+      if ( algorithm == "none" ) {
+        c_fsm.congestion_control = TCPConfig::CongestionControl::None;
+      } else if ( algorithm == "newreno" ) {
+        c_fsm.congestion_control = TCPConfig::CongestionControl::NewReno;
+      } else if ( algorithm == "bbr" ) {
+        c_fsm.congestion_control = TCPConfig::CongestionControl::BBR;
+      } else if ( algorithm == "dctcp" ) {
+        c_fsm.congestion_control = TCPConfig::CongestionControl::DCTCP;
+      } else {
+        show_usage( args[0], "ERROR: unknown congestion control algorithm." );
+        exit( 1 );
+      }
+      curr += 2;
+
+    } else if ( strncmp( "-P", args[curr], 3 ) == 0 ) {
+      check_argc( args, curr, "ERROR: -P requires one argument." );
+      c_fsm.pacing = true;
+      c_fsm.pacing_rate = strtoull( args[curr + 1], nullptr, 0 );
+      curr += 2;
+
+    } else if ( strncmp( "-E", args[curr], 3 ) == 0 ) {
+      c_fsm.ecn = true;
+      curr += 1;
+
+    } else if ( strncmp( "-K", args[curr], 3 ) == 0 ) {
+      c_fsm.sack = false;
+      curr += 1;
+
+    } else if ( strncmp( "-N", args[curr], 3 ) == 0 ) {
+      c_fsm.nodelay = true;
+      curr += 1;
+
+    } else if ( strncmp( "-D", args[curr], 3 ) == 0 ) {
+      check_argc( args, curr, "ERROR: -D requires one argument." );
+      c_fsm.ack_delay = strtol( args[curr + 1], nullptr, 0 );
+      curr += 2;
+
     } else if ( strncmp( "-d", args[curr], 3 ) == 0 ) {
       check_argc( args, curr, "ERROR: -t requires one argument." );
       tundev = args[curr + 1];
@@ -117,6 +195,11 @@ tuple<TCPConfig, FdAdapterConfig, bool, const char*> get_config( const span<char
         = static_cast<LossRateDnT>( static_cast<float>( numeric_limits<LossRateDnT>::max() ) * lossrate );
       curr += 2;
 
+    } else if ( strncmp( "-Lm", args[curr], 3 ) == 0 ) {
+      check_argc( args, curr, "ERROR: -Lm requires one argument." );
+      c_filt.path_mtu = strtol( args[curr + 1], nullptr, 0 );
+      curr += 2;
+
     } else if ( strncmp( "-h", args[curr], 3 ) == 0 ) {
       show_usage( args[0], nullptr );
       exit( 0 );
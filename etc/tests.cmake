@@ -23,6 +23,8 @@ ttest(byte_stream_one_write)
 ttest(byte_stream_two_writes)
 ttest(byte_stream_many_writes)
 ttest(byte_stream_stress_test)
+ttest(byte_stream_concurrent)
+ttest(buffer_pool)
 
 ttest(reassembler_single)
 ttest(reassembler_cap)
@@ -45,6 +47,8 @@ ttest(recv_reorder)
 ttest(recv_reorder_more)
 ttest(recv_close)
 ttest(recv_special)
+ttest(recv_sack)
+ttest(recv_window_scale)
 
 ttest(send_connect)
 ttest(send_transmit)
@@ -53,6 +57,22 @@ ttest(send_window)
 ttest(send_ack)
 ttest(send_close)
 ttest(send_extra)
+ttest(send_rtt)
+ttest(send_recovery)
+ttest(send_sack)
+ttest(send_pacing)
+ttest(send_mss)
+ttest(send_window_scale)
+ttest(send_timestamps)
+ttest(send_buffer)
+ttest(send_nagle)
+ttest(send_rack)
+ttest(send_rate)
+ttest(send_bbr)
+ttest(send_ecn)
+ttest(recv_ecn)
+ttest(peer_ack)
+ttest(send_congestion)
 
 ttest(net_interface)
 
@@ -76,6 +96,9 @@ add_custom_target (check6 COMMAND ${CMAKE_CTEST_COMMAND} --output-on-failure --s
 
 add_custom_target (speed COMMAND ${CMAKE_CTEST_COMMAND} --output-on-failure --timeout 12 -R '_speed_test')
 
+add_custom_target (bench COMMAND byte_stream_benchmark COMMAND reassembler_benchmark)
+add_dependencies (bench benchmarks)
+
 set(compile_name_opt "compile with optimization")
 add_test(NAME ${compile_name_opt}
   COMMAND "${CMAKE_COMMAND}" --build "${CMAKE_BINARY_DIR}" -t speed_testing)
@@ -1,8 +1,12 @@
 #include "byte_stream.hh"
+#include "buffer_pool.hh"
+
+#include <algorithm>
+#include <cstring>
 
 using namespace std;
 
-ByteStream::ByteStream( uint64_t capacity ) : capacity_( capacity ) {}
+ByteStream::ByteStream( uint64_t capacity ) : buffer_( capacity ), capacity_( capacity ) {}
 
 bool Writer::is_closed() const
 {
@@ -10,34 +14,42 @@ bool Writer::is_closed() const
 }
 
 void Writer::push( string data )
+{
+  const auto space = reserve( data.size() );
+  if ( !space.empty() ) {
+    memcpy( space.data(), data.data(), space.size() );
+    commit( space.size() );
+  }
+  // 数据已经拷进环形缓冲区，字符串本身交还给缓冲池复用
+  BufferPool::local().release( move( data ) );
+}
+
+span<char> Writer::reserve( uint64_t len )
+{
+  if ( is_closed() )
+    return {};
+  // 环形缓冲区的两段映射首尾相接，所以空闲空间总是连续的，不需要考虑回绕
+  len = min( len, available_capacity() );
+  if ( len == 0 )
+    return {};
+  return { buffer_.at( num_bytes_pushed_ ), len };
+}
+
+void Writer::commit( uint64_t len )
 {
   if ( is_closed() )
     return;
-  if ( data.size() > available_capacity() )
-    data.resize( available_capacity() );
-  if ( !data.empty() ) {
-    // 没事不要塞空字节字符串进去
-    num_bytes_pushed_ += data.size();
-    num_bytes_buffered_ += data.size();
-    bytes_.emplace( move( data ) );
-  }
-  // 临界条件：pop 了所有字节导致队列为空且 view_wnd_ 为空
-  if ( view_wnd_.empty() && !bytes_.empty() )
-    view_wnd_ = bytes_.front();
+  num_bytes_pushed_ += min( len, available_capacity() );
 }
 
 void Writer::close()
 {
-  if ( !is_closed_ ) {
-    is_closed_ = true;
-    // 防止重复关闭，然后不断塞入 EOF
-    bytes_.emplace( string( 1, EOF ) );
-  }
+  is_closed_ = true;
 }
 
 uint64_t Writer::available_capacity() const
 {
-  return capacity_ - num_bytes_buffered_;
+  return capacity_ - ( num_bytes_pushed_ - num_bytes_popped_ );
 }
 
 uint64_t Writer::bytes_pushed() const
@@ -47,7 +59,7 @@ uint64_t Writer::bytes_pushed() const
 
 bool Reader::is_finished() const
 {
-  // 当且仅当写者关闭、存在队列中未 pop 的字节数为 0
+  // 当且仅当写者关闭、存在缓冲区中未 pop 的字节数为 0
   return is_closed_ && bytes_buffered() == 0;
 }
 
@@ -58,26 +70,27 @@ uint64_t Reader::bytes_popped() const
 
 string_view Reader::peek() const
 {
-  return view_wnd_;
+  // 缓冲区中的全部字节在虚拟地址上是连续的，即使它们跨过了环的末尾
+  if ( bytes_buffered() == 0 )
+    return {};
+  return { buffer_.at( num_bytes_popped_ ), bytes_buffered() };
 }
 
-void Reader::pop( uint64_t len )
+void Reader::peek( vector<string_view>& views, uint64_t max_len, size_t max_views ) const
 {
-  auto remainder = len;
-  while ( remainder >= view_wnd_.size() && remainder != 0 ) {
-    // 不断清掉能从队列中 pop 出去的字节
-    remainder -= view_wnd_.size();
-    bytes_.pop();
-    view_wnd_ = bytes_.empty() ? ""sv : bytes_.front();
-  }
-  if ( !view_wnd_.empty() )
-    view_wnd_.remove_prefix( remainder );
+  views.clear();
+  // 环形缓冲区只需要一个视图；保留 vector 形式的接口，方便直接交给 writev
+  if ( bytes_buffered() == 0 || max_len == 0 || max_views == 0 )
+    return;
+  views.push_back( peek().substr( 0, max_len ) );
+}
 
-  num_bytes_buffered_ -= len;
-  num_bytes_popped_ += len;
+void Reader::pop( uint64_t len )
+{
+  num_bytes_popped_ += min( len, bytes_buffered() );
 }
 
 uint64_t Reader::bytes_buffered() const
 {
-  return num_bytes_buffered_;
+  return num_bytes_pushed_ - num_bytes_popped_;
 }
@@ -1,9 +1,12 @@
 #pragma once
 
+#include "mirrored_buffer.hh"
+
 #include <cstdint>
-#include <queue>
+#include <span>
 #include <string>
 #include <string_view>
+#include <vector>
 
 class Reader;
 class Writer;
@@ -24,12 +27,10 @@ public:
 
 protected:
   // Please add any additional state to the ByteStream here, and not to the Writer and Reader interfaces.
-  std::queue<std::string> bytes_ {};
-  std::string_view view_wnd_ {};
+  MirroredBuffer buffer_; // ring holding bytes [num_bytes_popped_, num_bytes_pushed_) of the stream
   uint64_t capacity_ {};
   uint64_t num_bytes_pushed_ {};
   uint64_t num_bytes_popped_ {};
-  uint64_t num_bytes_buffered_ {};
   bool is_closed_ {};
   bool error_ {};
 };
@@ -40,6 +41,9 @@ public:
   void push( std::string data ); // Push data to stream, but only as much as available capacity allows.
   void close();                  // Signal that the stream has reached its ending. Nothing more will be written.
 
+  std::span<char> reserve( uint64_t len ); // Writable space for up to `len` more bytes, inside the stream's storage
+  void commit( uint64_t len );             // Make the first `len` bytes of the reserved space visible to the Reader
+
   bool is_closed() const;              // Has the stream been closed?
   uint64_t available_capacity() const; // How many bytes can be pushed to the stream right now?
   uint64_t bytes_pushed() const;       // Total number of bytes cumulatively pushed to the stream
@@ -48,7 +52,10 @@ public:
 class Reader : public ByteStream
 {
 public:
-  std::string_view peek() const; // Peek at the next bytes in the buffer
+  std::string_view peek() const; // Peek at all the bytes in the buffer (as one contiguous view)
+  void peek( std::vector<std::string_view>& views, // Fill `views` with up to `max_len` buffered bytes,
+             uint64_t max_len = UINT64_MAX,        // in at most `max_views` views (e.g. for a vectored write)
+             size_t max_views = SIZE_MAX ) const;
   void pop( uint64_t len );      // Remove `len` bytes from the buffer
 
   bool is_finished() const;        // Is the stream finished (closed and fully popped)?
@@ -0,0 +1,163 @@
+#include "concurrent_byte_stream.hh"
+
+#include "exception.hh"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <sys/eventfd.h>
+
+using namespace std;
+
+ConcurrentByteStream::ConcurrentByteStream( uint64_t capacity )
+  : buffer_( capacity )
+  , capacity_( capacity )
+  , reader_event_( CheckSystemCall( "eventfd", eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC ) ) )
+  , writer_event_( CheckSystemCall( "eventfd", eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC ) ) )
+{}
+
+void ConcurrentByteStream::signal( FileDescriptor& event )
+{
+  const uint64_t one = 1;
+  event.write( string_view { reinterpret_cast<const char*>( &one ), sizeof( one ) } ); // NOLINT(*-reinterpret-cast)
+}
+
+void ConcurrentByteStream::clear( FileDescriptor& event )
+{
+  array<char, sizeof( uint64_t )> counter {};
+  event.read( span<char> { counter } ); // returns 0 (without blocking) if there was no signal
+}
+
+void ConcurrentByteStream::set_error()
+{
+  error_.store( true, memory_order_release );
+  signal( reader_event_ );
+  signal( writer_event_ );
+}
+
+/*
+ * Wakeups follow the usual store-then-load handshake: each side stores its own counter and then
+ * loads the other side's (both sequentially consistent). The writer signals if the reader had
+ * consumed everything it could see before this push; the reader signals if the writer had filled
+ * the ring before this pop. A side that clears its signal, then observes empty (or full), is
+ * guaranteed that the other side's next transition will see that state and signal it.
+ */
+
+void ConcurrentWriter::push( string_view data )
+{
+  const auto space = reserve( data.size() );
+  if ( space.empty() ) {
+    return;
+  }
+  memcpy( space.data(), data.data(), space.size() );
+  commit( space.size() );
+}
+
+span<char> ConcurrentWriter::reserve( uint64_t len )
+{
+  len = min( len, available_capacity() );
+  if ( is_closed() or len == 0 ) {
+    return {};
+  }
+  return { buffer_.at( num_bytes_pushed_.load( memory_order_relaxed ) ), len };
+}
+
+void ConcurrentWriter::commit( uint64_t len )
+{
+  len = min( len, available_capacity() );
+  if ( is_closed() or len == 0 ) {
+    return;
+  }
+  const uint64_t old_pushed = num_bytes_pushed_.load( memory_order_relaxed );
+  num_bytes_pushed_.store( old_pushed + len, memory_order_seq_cst );
+  if ( num_bytes_popped_.load( memory_order_seq_cst ) == old_pushed ) {
+    signal( reader_event_ ); // the reader may be waiting on an empty stream
+  }
+}
+
+void ConcurrentWriter::close()
+{
+  if ( not is_closed_.exchange( true, memory_order_release ) ) {
+    signal( reader_event_ );
+  }
+}
+
+bool ConcurrentWriter::is_closed() const
+{
+  return is_closed_.load( memory_order_acquire );
+}
+
+uint64_t ConcurrentWriter::available_capacity() const
+{
+  return capacity_
+         - ( num_bytes_pushed_.load( memory_order_relaxed ) - num_bytes_popped_.load( memory_order_acquire ) );
+}
+
+uint64_t ConcurrentWriter::bytes_pushed() const
+{
+  return num_bytes_pushed_.load( memory_order_relaxed );
+}
+
+string_view ConcurrentReader::peek() const
+{
+  const uint64_t buffered = bytes_buffered();
+  if ( buffered == 0 ) {
+    return {};
+  }
+  return { buffer_.at( num_bytes_popped_.load( memory_order_relaxed ) ), buffered };
+}
+
+void ConcurrentReader::pop( uint64_t len )
+{
+  len = min( len, bytes_buffered() );
+  if ( len == 0 ) {
+    return;
+  }
+  const uint64_t old_popped = num_bytes_popped_.load( memory_order_relaxed );
+  num_bytes_popped_.store( old_popped + len, memory_order_seq_cst );
+  if ( num_bytes_pushed_.load( memory_order_seq_cst ) == old_popped + capacity_ ) {
+    signal( writer_event_ ); // the writer may be waiting on a full stream
+  }
+}
+
+bool ConcurrentReader::is_finished() const
+{
+  // Check the flag first: bytes pushed before close() are visible once the flag is.
+  return is_closed_.load( memory_order_acquire ) and bytes_buffered() == 0;
+}
+
+uint64_t ConcurrentReader::bytes_buffered() const
+{
+  return num_bytes_pushed_.load( memory_order_acquire ) - num_bytes_popped_.load( memory_order_relaxed );
+}
+
+uint64_t ConcurrentReader::bytes_popped() const
+{
+  return num_bytes_popped_.load( memory_order_relaxed );
+}
+
+ConcurrentReader& ConcurrentByteStream::reader()
+{
+  static_assert( sizeof( ConcurrentReader ) == sizeof( ConcurrentByteStream ),
+                 "Please add member variables to the ConcurrentByteStream base, not the Reader." );
+
+  return static_cast<ConcurrentReader&>( *this ); // NOLINT(*-downcast)
+}
+
+const ConcurrentReader& ConcurrentByteStream::reader() const
+{
+  return static_cast<const ConcurrentReader&>( *this ); // NOLINT(*-downcast)
+}
+
+ConcurrentWriter& ConcurrentByteStream::writer()
+{
+  static_assert( sizeof( ConcurrentWriter ) == sizeof( ConcurrentByteStream ),
+                 "Please add member variables to the ConcurrentByteStream base, not the Writer." );
+
+  return static_cast<ConcurrentWriter&>( *this ); // NOLINT(*-downcast)
+}
+
+const ConcurrentWriter& ConcurrentByteStream::writer() const
+{
+  return static_cast<const ConcurrentWriter&>( *this ); // NOLINT(*-downcast)
+}
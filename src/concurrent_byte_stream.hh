@@ -0,0 +1,92 @@
+#pragma once
+
+#include "file_descriptor.hh"
+#include "mirrored_buffer.hh"
+
+#include <atomic>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+class ConcurrentReader;
+class ConcurrentWriter;
+
+/*
+ * A ByteStream that may be written by one thread and read by another at the same time
+ * (single producer, single consumer). The bytes live in a mirrored ring; the writer publishes
+ * them by advancing `num_bytes_pushed_` (release) and the reader frees space by advancing
+ * `num_bytes_popped_` (release), so neither side takes a lock or makes a system call to move data.
+ *
+ * Each side also has an eventfd that can be registered with an EventLoop (Direction::In):
+ * the reader's fd becomes readable when bytes (or the end of the stream) may have arrived,
+ * and the writer's fd becomes readable when space may have been freed. A side should call
+ * clear_readiness() before it checks the stream, and wait on its fd only after it has seen
+ * the stream empty (reader) or full (writer); a signal is sent only on those transitions.
+ */
+class ConcurrentByteStream
+{
+public:
+  explicit ConcurrentByteStream( uint64_t capacity );
+
+  // Helper functions to access the ConcurrentByteStream's Reader and Writer interfaces
+  ConcurrentReader& reader();
+  const ConcurrentReader& reader() const;
+  ConcurrentWriter& writer();
+  const ConcurrentWriter& writer() const;
+
+  void set_error(); // Signal that the stream suffered an error (wakes up both sides).
+  bool has_error() const { return error_.load( std::memory_order_acquire ); }; // Has the stream had an error?
+
+  // Shared by two threads at once, so a ConcurrentByteStream can be neither copied nor moved
+  ConcurrentByteStream( const ConcurrentByteStream& ) = delete;
+  ConcurrentByteStream& operator=( const ConcurrentByteStream& ) = delete;
+  ConcurrentByteStream( ConcurrentByteStream&& ) = delete;
+  ConcurrentByteStream& operator=( ConcurrentByteStream&& ) = delete;
+  ~ConcurrentByteStream() = default;
+
+protected:
+  // Please add any additional state to the ConcurrentByteStream here, and not to the Writer and Reader interfaces.
+  MirroredBuffer buffer_;
+  uint64_t capacity_;
+  alignas( 64 ) std::atomic<uint64_t> num_bytes_pushed_ {}; // only stored by the writer thread
+  alignas( 64 ) std::atomic<uint64_t> num_bytes_popped_ {}; // only stored by the reader thread
+  std::atomic<bool> is_closed_ {};
+  std::atomic<bool> error_ {};
+  FileDescriptor reader_event_; // eventfd: bytes (or EOF/error) may be available
+  FileDescriptor writer_event_; // eventfd: space (or error) may be available
+
+  static void signal( FileDescriptor& event );
+  static void clear( FileDescriptor& event );
+};
+
+class ConcurrentWriter : public ConcurrentByteStream
+{
+public:
+  void push( std::string_view data ); // Push data to stream, but only as much as available capacity allows.
+  void close();                       // Signal that the stream has reached its ending.
+
+  std::span<char> reserve( uint64_t len ); // Writable space for up to `len` more bytes, inside the stream's storage
+  void commit( uint64_t len );             // Make the first `len` bytes of the reserved space visible to the Reader
+
+  bool is_closed() const;              // Has the stream been closed?
+  uint64_t available_capacity() const; // How many bytes can be pushed to the stream right now?
+  uint64_t bytes_pushed() const;       // Total number of bytes cumulatively pushed to the stream
+
+  FileDescriptor& readiness_fd() { return writer_event_; } // Readable when space may have been freed
+  void clear_readiness() { clear( writer_event_ ); }       // Consume the signal before checking for space
+};
+
+class ConcurrentReader : public ConcurrentByteStream
+{
+public:
+  std::string_view peek() const; // Peek at all the bytes in the buffer (as one contiguous view)
+  void pop( uint64_t len );      // Remove `len` bytes from the buffer
+
+  bool is_finished() const;        // Is the stream finished (closed and fully popped)?
+  uint64_t bytes_buffered() const; // Number of bytes currently buffered (pushed and not popped)
+  uint64_t bytes_popped() const;   // Total number of bytes cumulatively popped from stream
+
+  FileDescriptor& readiness_fd() { return reader_event_; } // Readable when bytes or EOF may have arrived
+  void clear_readiness() { clear( reader_event_ ); }       // Consume the signal before checking for bytes
+};
@@ -0,0 +1,321 @@
+#include "congestion_controller.hh"
+
+#include <algorithm>
+
+using namespace std;
+
+uint64_t initial_window( uint64_t mss )
+{
+  return min( 10 * mss, max<uint64_t>( 2 * mss, 14600 ) );
+}
+
+NewReno::NewReno( uint64_t mss ) : mss_( mss ), cwnd_( initial_window( mss ) ) {}
+
+void NewReno::on_ack( const AckEvent& ack )
+{
+  // 发送方没有把窗口用满时，ACK 不能证明更大的窗口可行，不增长 cwnd（RFC 7661）
+  if ( ack.app_limited && ack.prior_in_flight < cwnd_ ) {
+    return;
+  }
+
+  if ( cwnd_ < ssthresh_ ) {
+    // 慢启动：按确认的字节数增长，但一个 ACK 最多 ABC_LIMIT 个 MSS，避免 ACK 压缩引起突发
+    cwnd_ += min( ack.acked_bytes, ABC_LIMIT * mss_ );
+    return;
+  }
+
+  // 拥塞避免：每确认一个 cwnd 的字节，cwnd 增长一个 MSS
+  bytes_acked_ += ack.acked_bytes;
+  if ( bytes_acked_ >= cwnd_ ) {
+    bytes_acked_ -= cwnd_;
+    cwnd_ += mss_;
+  }
+}
+
+void NewReno::on_loss( uint64_t bytes_in_flight )
+{
+  ssthresh_ = max( bytes_in_flight / 2, 2 * mss_ );
+  cwnd_ = ssthresh_;
+  bytes_acked_ = 0;
+}
+
+void NewReno::on_rto( uint64_t bytes_in_flight )
+{
+  ssthresh_ = max( bytes_in_flight / 2, 2 * mss_ );
+  cwnd_ = mss_; // 损失窗口：超时之后从一个报文段重新慢启动
+  bytes_acked_ = 0;
+}
+
+void NewReno::undo( uint64_t prior_cwnd, uint64_t prior_ssthresh )
+{
+  // 超时之后已经增长的部分也保留
+  cwnd_ = max( cwnd_, prior_cwnd );
+  ssthresh_ = max( ssthresh_, prior_ssthresh );
+}
+
+void NewReno::set_mss( uint64_t mss )
+{
+  mss_ = mss;
+}
+
+BBR::BBR( uint64_t mss ) : mss_( mss ), cwnd_( initial_window( mss ) ) {}
+
+DCTCP::DCTCP( uint64_t mss ) : NewReno( mss ), window_end_( cwnd_ ) {}
+
+void DCTCP::on_ack( const AckEvent& ack )
+{
+  NewReno::on_ack( ack );
+
+  window_acked_ += ack.acked_bytes;
+  if ( ack.ece )
+    window_marked_ += ack.acked_bytes;
+  if ( window_acked_ < window_end_ )
+    return;
+
+  // 每个窗口更新一次：alpha = (1 - g) * alpha + g * F，F 是这个窗口里被标记的比例
+  const uint64_t fraction = window_marked_ * ALPHA_ONE / window_acked_;
+  alpha_ = alpha_ - ( alpha_ >> ALPHA_SHIFT ) + ( fraction >> ALPHA_SHIFT );
+  window_end_ = cwnd_;
+  window_acked_ = 0;
+  window_marked_ = 0;
+}
+
+void DCTCP::on_ecn( uint64_t /* bytes_in_flight */ )
+{
+  // cwnd = cwnd * (1 - alpha / 2)
+  ssthresh_ = max( cwnd_ - cwnd_ * alpha_ / ( 2 * ALPHA_ONE ), 2 * mss_ );
+  cwnd_ = ssthresh_;
+  bytes_acked_ = 0;
+}
+
+uint64_t BBR::bdp( uint64_t gain_pct ) const
+{
+  if ( bw_samples_.empty() || min_rtt_ms_ == UINT64_MAX )
+    return 0;
+  return bottleneck_bandwidth() * min_rtt_ms_ / 1000 * gain_pct / 100;
+}
+
+uint64_t BBR::pacing_gain() const
+{
+  switch ( mode_ ) {
+    case Mode::Startup:
+      return HIGH_GAIN_PCT;
+    case Mode::Drain:
+      return DRAIN_GAIN_PCT;
+    case Mode::ProbeBW:
+      return PROBE_BW_GAINS_PCT.at( cycle_index_ );
+    case Mode::ProbeRTT:
+      break;
+  }
+  return 100;
+}
+
+uint64_t BBR::cwnd_gain() const
+{
+  switch ( mode_ ) {
+    case Mode::Startup:
+    case Mode::Drain:
+      return HIGH_GAIN_PCT;
+    case Mode::ProbeBW:
+      return CWND_GAIN_PCT;
+    case Mode::ProbeRTT:
+      break;
+  }
+  return 100;
+}
+
+void BBR::on_ack( const AckEvent& /* ack */ )
+{
+  // 模型只按交付速率样本更新（on_rate_sample），不按确认的字节数增长窗口
+}
+
+void BBR::on_rate_sample( const RateSample& rs )
+{
+  update_round( rs );
+  update_bandwidth( rs );
+  check_full_pipe( rs );
+  update_min_rtt( rs );
+  update_mode( rs );
+  update_pacing_rate( rs );
+  update_cwnd( rs );
+}
+
+void BBR::update_round( const RateSample& rs )
+{
+  round_start_ = rs.prior_delivered >= next_round_delivered_;
+  if ( round_start_ ) {
+    next_round_delivered_ = rs.delivered;
+    ++round_count_;
+  }
+}
+
+void BBR::update_bandwidth( const RateSample& rs )
+{
+  // 受应用限制的样本偏低，只有超过当前估计时才采用
+  if ( rs.delivery_rate > 0 && ( !rs.app_limited || rs.delivery_rate >= bottleneck_bandwidth() ) ) {
+    while ( !bw_samples_.empty() && bw_samples_.back().second <= rs.delivery_rate ) {
+      bw_samples_.pop_back();
+    }
+    bw_samples_.emplace_back( round_count_, rs.delivery_rate );
+  }
+  // 过期的最大值让位给窗口里后来的样本；只剩一个时保留，没有更新的信息
+  while ( bw_samples_.size() > 1 && bw_samples_.front().first + BW_WINDOW_ROUNDS <= round_count_ ) {
+    bw_samples_.pop_front();
+  }
+}
+
+void BBR::check_full_pipe( const RateSample& rs )
+{
+  if ( filled_pipe_ || !round_start_ || rs.app_limited )
+    return;
+  if ( bottleneck_bandwidth() * 100 >= full_bw_ * FULL_BW_GROWTH_PCT ) {
+    full_bw_ = bottleneck_bandwidth();
+    full_bw_rounds_ = 0;
+    return;
+  }
+  filled_pipe_ = ++full_bw_rounds_ >= FULL_BW_ROUNDS;
+}
+
+void BBR::update_min_rtt( const RateSample& rs )
+{
+  const bool expired = min_rtt_ms_ != UINT64_MAX && rs.now_ms > min_rtt_stamp_ms_ + MIN_RTT_WINDOW_MS;
+  if ( rs.rtt_ms.has_value() && ( *rs.rtt_ms <= min_rtt_ms_ || expired ) ) {
+    min_rtt_ms_ = *rs.rtt_ms;
+    min_rtt_stamp_ms_ = rs.now_ms;
+  }
+  if ( expired && mode_ != Mode::ProbeRTT ) {
+    mode_ = Mode::ProbeRTT;
+    prior_cwnd_ = cwnd_;
+    probe_rtt_done_ms_.reset();
+  }
+}
+
+void BBR::enter_probe_bw( uint64_t now_ms )
+{
+  // 从一个匀速阶段开始（而不是随机选一个），行为可以重复
+  mode_ = Mode::ProbeBW;
+  cycle_index_ = 2;
+  cycle_stamp_ms_ = now_ms;
+  loss_in_cycle_ = false;
+}
+
+void BBR::update_mode( const RateSample& rs )
+{
+  switch ( mode_ ) {
+    case Mode::Startup:
+      if ( !filled_pipe_ )
+        break;
+      mode_ = Mode::Drain;
+      [[fallthrough]];
+
+    case Mode::Drain:
+      if ( rs.bytes_in_flight <= bdp( 100 ) )
+        enter_probe_bw( rs.now_ms );
+      break;
+
+    case Mode::ProbeBW: {
+      // 每个阶段持续一个最小 RTT；探测阶段还要把在途数据推到 1.25 BDP（或者出现丢包），
+      // 排空阶段在途数据降到 BDP 就可以提前结束
+      const uint64_t gain = pacing_gain();
+      const bool full_length = rs.now_ms - cycle_stamp_ms_ > min_rtt_ms_;
+      bool next = full_length;
+      if ( gain > 100 )
+        next = full_length && ( loss_in_cycle_ || rs.bytes_in_flight >= bdp( gain ) );
+      else if ( gain < 100 )
+        next = full_length || rs.bytes_in_flight <= bdp( 100 );
+      if ( next ) {
+        cycle_index_ = ( cycle_index_ + 1 ) % PROBE_BW_GAINS_PCT.size();
+        cycle_stamp_ms_ = rs.now_ms;
+        loss_in_cycle_ = false;
+      }
+      break;
+    }
+
+    case Mode::ProbeRTT:
+      if ( !probe_rtt_done_ms_ ) {
+        if ( rs.bytes_in_flight <= MIN_CWND_SEGMENTS * mss_ ) {
+          probe_rtt_done_ms_ = rs.now_ms + PROBE_RTT_MS;
+          probe_rtt_round_done_ = false;
+          next_round_delivered_ = rs.delivered;
+        }
+        break;
+      }
+      probe_rtt_round_done_ |= round_start_;
+      if ( probe_rtt_round_done_ && rs.now_ms >= *probe_rtt_done_ms_ ) {
+        min_rtt_stamp_ms_ = rs.now_ms;
+        cwnd_ = max( cwnd_, prior_cwnd_ );
+        if ( filled_pipe_ )
+          enter_probe_bw( rs.now_ms );
+        else
+          mode_ = Mode::Startup;
+      }
+      break;
+  }
+}
+
+void BBR::update_pacing_rate( const RateSample& rs )
+{
+  // 还没有速率时，按初始窗口和第一个 RTT 样本估计
+  if ( pacing_rate_ == 0 && rs.rtt_ms.has_value() )
+    pacing_rate_ = cwnd_ * HIGH_GAIN_PCT * 10 / max<uint64_t>( *rs.rtt_ms, 1 );
+
+  // 管道满之前只提高不降低：握手和受应用限制的样本会低估带宽
+  const uint64_t rate = bottleneck_bandwidth() * pacing_gain() / 100;
+  if ( filled_pipe_ || rate > pacing_rate_ )
+    pacing_rate_ = rate;
+}
+
+void BBR::update_cwnd( const RateSample& rs )
+{
+  const uint64_t min_cwnd = MIN_CWND_SEGMENTS * mss_;
+  if ( mode_ == Mode::ProbeRTT ) {
+    cwnd_ = min( cwnd_, min_cwnd );
+    return;
+  }
+
+  // 目标是按增益计算的 BDP，再加上几个报文段，给 ACK 的聚合和延迟留出余地
+  const uint64_t bdp = BBR::bdp( cwnd_gain() );
+  const uint64_t target = bdp > 0 ? bdp + 3 * mss_ : initial_window( mss_ );
+  if ( filled_pipe_ )
+    cwnd_ = min( cwnd_ + rs.newly_delivered, target );
+  else if ( cwnd_ < target || rs.delivered < initial_window( mss_ ) )
+    cwnd_ += rs.newly_delivered;
+  cwnd_ = max( cwnd_, min_cwnd );
+}
+
+void BBR::on_loss( uint64_t /* bytes_in_flight */ )
+{
+  // 丢包不改变模型，只让 ProbeBW 结束这一轮探测；恢复期间由发送方的 PRR 按包守恒发送
+  loss_in_cycle_ = true;
+}
+
+void BBR::on_rto( uint64_t /* bytes_in_flight */ )
+{
+  // 从一个报文段重新开始，之后每个 ACK 按交付的数据增长回目标窗口
+  cwnd_ = mss_;
+}
+
+void BBR::undo( uint64_t prior_cwnd, uint64_t /* prior_ssthresh */ )
+{
+  cwnd_ = max( cwnd_, prior_cwnd );
+}
+
+void BBR::set_mss( uint64_t mss )
+{
+  mss_ = mss;
+}
+
+unique_ptr<CongestionController> make_congestion_controller( TCPConfig::CongestionControl algorithm, uint64_t mss )
+{
+  switch ( algorithm ) {
+    case TCPConfig::CongestionControl::NewReno:
+      return make_unique<NewReno>( mss );
+    case TCPConfig::CongestionControl::BBR:
+      return make_unique<BBR>( mss );
+    case TCPConfig::CongestionControl::DCTCP:
+      return make_unique<DCTCP>( mss );
+    case TCPConfig::CongestionControl::None:
+      break;
+  }
+  return {};
+}
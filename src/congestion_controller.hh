@@ -0,0 +1,222 @@
+#pragma once
+
+#include "tcp_config.hh"
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <utility>
+
+// 一个 ACK 确认了新数据时，发送方交给拥塞控制算法的信息
+struct AckEvent
+{
+  uint64_t now_ms {};          // 发送方的当前时间
+  uint64_t acked_bytes {};     // 这个 ACK 新确认的序号数
+  uint64_t prior_in_flight {}; // 处理这个 ACK 之前在途的序号数
+  bool app_limited {};         // 发送方最近一次停止发送是因为没有数据可发，而不是受窗口限制
+  bool ece {};                 // 这个 ACK 带有 ECE：接收方收到了被路由器标记为拥塞的报文段（两端协商了 ECN 时）
+};
+
+// 一个 ACK 的交付速率样本（draft-cheng-iccrg-delivery-rate-estimation）：从这次到达的报文段里最近发送的那个
+// 发出，到它到达接收方，这段时间里接收方收到了多少数据
+struct RateSample
+{
+  uint64_t now_ms {};                // 发送方的当前时间
+  uint64_t delivered {};             // 连接开始以来到达接收方的序号数
+  uint64_t prior_delivered {};       // 那个报文段发出时的 delivered
+  uint64_t newly_delivered {};       // 这个 ACK 新到达接收方的序号数（累计确认的加上新 SACK 的）
+  uint64_t interval_ms {};           // 样本的时间间隔：发送间隔和确认间隔中较长的那个
+  uint64_t delivery_rate {};         // 交付速率（字节/秒）；间隔比最小 RTT 还短、样本不可信时为 0
+  std::optional<uint64_t> rtt_ms {}; // 这个 ACK 的 RTT 样本
+  uint64_t bytes_in_flight {};       // 处理完这个 ACK 之后在途的序号数
+  bool app_limited {};               // 那个报文段发出时发送方受应用限制，速率只是路径能力的下限
+};
+
+// 拥塞控制算法的接口。TCPSender 在 push/receive/tick 中把事件交给它，并且在途数据不超过 cwnd()
+class CongestionController
+{
+public:
+  virtual ~CongestionController() = default;
+
+  virtual std::string_view name() const = 0;
+
+  virtual uint64_t cwnd() const = 0;     // 拥塞窗口（序号数）
+  virtual uint64_t ssthresh() const = 0; // 慢启动阈值
+
+  // 收到确认了新数据的 ACK
+  virtual void on_ack( const AckEvent& ack ) = 0;
+
+  // 每个让接收方收到了新数据的 ACK（包括快速恢复中的和只带 SACK 的）都产生一个交付速率样本
+  virtual void on_rate_sample( const RateSample& /* rs */ ) {}
+
+  // 算法要求的发送速率（字节/秒）；为 0 时由发送方按 cwnd/SRTT 计算
+  virtual uint64_t pacing_rate() const { return 0; }
+
+  // 检测到丢包（例如重复 ACK），bytes_in_flight 是检测到丢包时在途的序号数
+  virtual void on_loss( uint64_t bytes_in_flight ) = 0;
+
+  // 重传计时器超时
+  virtual void on_rto( uint64_t bytes_in_flight ) = 0;
+
+  // 收到 ECE（RFC 3168），发送方保证每个窗口最多一次。默认和检测到丢包一样降窗，只是不需要重传
+  virtual void on_ecn( uint64_t bytes_in_flight ) { on_loss( bytes_in_flight ); }
+
+  // 之前的超时被证明是虚假的（原来的报文段没有丢）：恢复超时之前的 cwnd 和 ssthresh
+  virtual void undo( uint64_t prior_cwnd, uint64_t prior_ssthresh ) = 0;
+
+  // 连接中途发送方的 MSS 变了（路径 MTU 探测）；窗口不变，只改变按 MSS 计算的步长
+  virtual void set_mss( uint64_t mss ) = 0;
+};
+
+// RFC 5681 的慢启动和拥塞避免，窗口增长按 RFC 3465 的字节计数（ABC）
+class NewReno : public CongestionController
+{
+public:
+  static constexpr uint64_t ABC_LIMIT = 2; // 慢启动时一个 ACK 最多让 cwnd 增长 ABC_LIMIT 个 MSS
+
+  explicit NewReno( uint64_t mss );
+
+  std::string_view name() const override { return "newreno"; }
+
+  uint64_t cwnd() const override { return cwnd_; }
+  uint64_t ssthresh() const override { return ssthresh_; }
+
+  void on_ack( const AckEvent& ack ) override;
+  void on_loss( uint64_t bytes_in_flight ) override;
+  void on_rto( uint64_t bytes_in_flight ) override;
+  void undo( uint64_t prior_cwnd, uint64_t prior_ssthresh ) override;
+  void set_mss( uint64_t mss ) override;
+
+protected:
+  uint64_t mss_;
+  uint64_t cwnd_;
+  uint64_t ssthresh_ { UINT64_MAX };
+  uint64_t bytes_acked_ {}; // 拥塞避免阶段累计确认的字节数，攒够一个 cwnd 才增长一个 MSS
+};
+
+// DCTCP（RFC 8257）：按每个窗口里带 ECE 确认的字节比例估计拥塞程度 alpha，收到 ECE 时 cwnd 只减少
+// alpha/2 而不是减半，路由器的队列可以保持得很短。其余（窗口增长、丢包和超时）和 NewReno 一样
+class DCTCP : public NewReno
+{
+public:
+  static constexpr uint64_t ALPHA_ONE = 1024; // alpha 的定点表示：1024 表示 1
+  static constexpr uint64_t ALPHA_SHIFT = 4;  // 估计 alpha 的增益 g = 1/16
+
+  explicit DCTCP( uint64_t mss );
+
+  std::string_view name() const override { return "dctcp"; }
+
+  void on_ack( const AckEvent& ack ) override;
+  void on_ecn( uint64_t bytes_in_flight ) override;
+
+  uint64_t alpha() const { return alpha_; }
+
+private:
+  uint64_t alpha_ { ALPHA_ONE }; // 从 1 开始：还不知道标记的比例时，第一次降窗和 NewReno 一样减半
+  uint64_t window_end_;          // 这个观察窗口要确认这么多字节才结束，取窗口开始时的 cwnd
+  uint64_t window_acked_ {};     // 这个观察窗口里确认的字节数
+  uint64_t window_marked_ {};    // 其中带 ECE 确认的字节数
+};
+
+// BBR（v1）：不把丢包当作拥塞信号，而是测量瓶颈带宽（交付速率的窗口最大值）和最小 RTT，
+// 按带宽乘以增益限速发送，cwnd 限制在两倍 BDP 左右
+class BBR : public CongestionController
+{
+public:
+  enum class Mode : uint8_t
+  {
+    Startup,  // 以 2/ln2 的增益指数增长，直到带宽不再增长
+    Drain,    // 以倒数的增益发送，排空 Startup 在瓶颈队列里留下的数据
+    ProbeBW,  // 按增益循环轮流探测更多带宽和排空队列
+    ProbeRTT, // 最小 RTT 太久没有更新：把在途数据降到几个报文段，重新测量
+  };
+
+  static constexpr uint64_t HIGH_GAIN_PCT = 289;       // Startup 的增益：2/ln2
+  static constexpr uint64_t DRAIN_GAIN_PCT = 35;       // Drain 的增益：ln2/2
+  static constexpr uint64_t CWND_GAIN_PCT = 200;       // ProbeBW 的 cwnd 是两倍 BDP
+  static constexpr uint64_t BW_WINDOW_ROUNDS = 10;     // 瓶颈带宽取最近这么多个来回里的最大值
+  static constexpr uint64_t MIN_RTT_WINDOW_MS = 10000; // 最小 RTT 这么久没有更新就进入 ProbeRTT
+  static constexpr uint64_t PROBE_RTT_MS = 200;        // ProbeRTT 至少持续这么久（还要至少一个来回）
+  static constexpr uint64_t MIN_CWND_SEGMENTS = 4;     // cwnd 的下限，也是 ProbeRTT 的 cwnd
+  static constexpr uint64_t FULL_BW_GROWTH_PCT = 125;  // 带宽增长不到这么多算没有增长
+  static constexpr uint64_t FULL_BW_ROUNDS = 3;        // 连续这么多个来回没有增长就认为管道满了
+
+  // ProbeBW 每个最小 RTT 换一个增益：先探测更多带宽，再排空探测时在队列里留下的数据，然后匀速
+  static constexpr std::array<uint64_t, 8> PROBE_BW_GAINS_PCT { 125, 75, 100, 100, 100, 100, 100, 100 };
+
+  explicit BBR( uint64_t mss );
+
+  std::string_view name() const override { return "bbr"; }
+
+  uint64_t cwnd() const override { return cwnd_; }
+  uint64_t ssthresh() const override { return UINT64_MAX; } // 没有慢启动阈值：恢复期间由 PRR 按包守恒发送
+  uint64_t pacing_rate() const override { return pacing_rate_; }
+
+  void on_ack( const AckEvent& ack ) override;
+  void on_rate_sample( const RateSample& rs ) override;
+  void on_loss( uint64_t bytes_in_flight ) override;
+  void on_rto( uint64_t bytes_in_flight ) override;
+  void undo( uint64_t prior_cwnd, uint64_t prior_ssthresh ) override;
+  void set_mss( uint64_t mss ) override;
+
+  Mode mode() const { return mode_; }
+  uint64_t bottleneck_bandwidth() const { return bw_samples_.empty() ? 0 : bw_samples_.front().second; }
+  uint64_t min_RTT_ms() const { return min_rtt_ms_; }
+
+private:
+  //  按增益计算的 BDP（序号数）；还没有带宽或 RTT 样本时为 0
+  uint64_t bdp( uint64_t gain_pct ) const;
+
+  uint64_t pacing_gain() const;
+  uint64_t cwnd_gain() const;
+
+  void update_round( const RateSample& rs );
+  void update_bandwidth( const RateSample& rs );
+  void check_full_pipe( const RateSample& rs );
+  void update_min_rtt( const RateSample& rs );
+  void update_mode( const RateSample& rs );
+  void update_pacing_rate( const RateSample& rs );
+  void update_cwnd( const RateSample& rs );
+  void enter_probe_bw( uint64_t now_ms );
+
+  uint64_t mss_;
+  uint64_t cwnd_;
+  uint64_t pacing_rate_ {};
+  Mode mode_ { Mode::Startup };
+
+  //  按来回计数：样本的报文段发出时的 delivered 越过 next_round_delivered_，就开始了一个新的来回
+  uint64_t round_count_ {};
+  uint64_t next_round_delivered_ {};
+  bool round_start_ {};
+
+  //  瓶颈带宽的窗口最大值过滤器：(来回编号, 速率)，速率从前往后递减
+  std::deque<std::pair<uint64_t, uint64_t>> bw_samples_ {};
+
+  uint64_t min_rtt_ms_ { UINT64_MAX };
+  uint64_t min_rtt_stamp_ms_ {};
+
+  //  Startup 判断管道是否已满
+  bool filled_pipe_ {};
+  uint64_t full_bw_ {};
+  uint64_t full_bw_rounds_ {};
+
+  //  ProbeBW 的增益循环
+  size_t cycle_index_ {};
+  uint64_t cycle_stamp_ms_ {};
+  bool loss_in_cycle_ {};
+
+  //  ProbeRTT：在途数据降下来之后持续到什么时候，以及这期间是否已经过了一个来回
+  std::optional<uint64_t> probe_rtt_done_ms_ {};
+  bool probe_rtt_round_done_ {};
+  uint64_t prior_cwnd_ {}; // 进入 ProbeRTT 之前的 cwnd，之后恢复
+};
+
+// RFC 6928 的初始窗口：min(10*MSS, max(2*MSS, 14600))
+uint64_t initial_window( uint64_t mss );
+
+// 按配置创建拥塞控制算法；CongestionControl::None 返回空指针（只受接收方窗口限制）
+std::unique_ptr<CongestionController> make_congestion_controller( TCPConfig::CongestionControl algorithm,
+                                                                  uint64_t mss );
@@ -0,0 +1,26 @@
+#include "pacer.hh"
+
+#include <algorithm>
+
+using namespace std;
+
+Pacer::Pacer( uint64_t mss ) : burst_( BURST_SEGMENTS * mss * 1000 ), tokens_( burst_ ) {}
+
+void Pacer::set_mss( uint64_t mss )
+{
+  burst_ = BURST_SEGMENTS * mss * 1000;
+  tokens_ = min( tokens_, burst_ );
+}
+
+void Pacer::tick( uint64_t ms_since_last_tick, bool backlogged )
+{
+  // 有数据在等令牌时，这段时间的令牌全部保留，发送速率才不受 tick 间隔影响；空闲时最多攒下一个桶
+  tokens_ += rate_ * ms_since_last_tick;
+  if ( !backlogged )
+    tokens_ = min( tokens_, burst_ );
+}
+
+void Pacer::on_send( uint64_t bytes )
+{
+  tokens_ -= min( tokens_, bytes * 1000 );
+}
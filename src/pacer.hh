@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+
+// 令牌桶发送调度器：令牌按发送速率随 tick() 累积，发出一个报文段要消耗同样字节数的令牌，
+// 这样一个窗口的数据会在一个 RTT 里均匀地发出去，而不是一次性涌进路由器的队列
+class Pacer
+{
+public:
+  static constexpr uint64_t BURST_SEGMENTS = 2; // 空闲之后最多能连续发出的报文段数
+
+  explicit Pacer( uint64_t mss );
+
+  //  发送速率（字节/秒）；为 0 时不限速（例如还没有测到 RTT）
+  void set_rate( uint64_t bytes_per_s ) { rate_ = bytes_per_s; }
+  uint64_t rate() const { return rate_; }
+
+  //  MSS 变了（协商对端 MSS、MTU 探测成功）之后，桶的容量跟着变，空闲之后仍然能连续发出 BURST_SEGMENTS 个报文段
+  void set_mss( uint64_t mss );
+
+  //  按速率补充令牌；backlogged 表示有数据在等令牌
+  void tick( uint64_t ms_since_last_tick, bool backlogged );
+
+  //  现在能不能发出 bytes 个序号
+  bool can_send( uint64_t bytes ) const { return rate_ == 0 || tokens_ >= bytes * 1000; }
+
+  //  发出了 bytes 个序号，消耗令牌（重传不等令牌，令牌不够时扣到 0 为止）
+  void on_send( uint64_t bytes );
+
+private:
+  uint64_t burst_;  // 桶的容量，以千分之一字节计
+  uint64_t rate_ {};
+  uint64_t tokens_; // 以千分之一字节计：速率（字节/秒）乘以毫秒数正好是这个单位
+};
@@ -1,35 +1,63 @@
 #include "reassembler.hh"
+#include "buffer_pool.hh"
 #include <algorithm>
+#include <bit>
+#include <cstring>
+#include <iterator>
 
 using namespace std;
 
+Reassembler::Reassembler( ByteStream&& output, size_t max_fragments, Storage storage, ReassemblyBudget* budget )
+  : storage_( storage ), max_fragments_( max_fragments ), lease_( budget ), output_( std::move( output ) )
+{
+  if ( storage_ == Storage::Window ) {
+    // 窗口不会超过流的容量，所以位图按不小于容量的 2 的幂取模，窗口内的序号不会落到同一位上
+    const uint64_t capacity = output_.writer().available_capacity();
+    received_.resize( bit_ceil( max<uint64_t>( capacity, 64 ) ) / 64 );
+  }
+}
+
 void Reassembler::insert( uint64_t first_index, string data, bool is_last_substring )
 {
   Writer& bytes_writer = output_.writer();
-  // unacceptable_index:Reassembler能够接受的索引上限
-  // 第一种情况：first_index > unacceptable_index
-  //*****如果first_index + data.size() <= expecting_index_的情况呢？？？
-  if ( const uint64_t unacceptable_index = expecting_index_ + bytes_writer.available_capacity();
-       bytes_writer.is_closed() || bytes_writer.available_capacity() == 0 || first_index >= unacceptable_index )
+  if ( bytes_writer.is_closed() ) {
+    BufferPool::local().release( move( data ) );
     return;
+  }
 
-  // 第二种情况：first_index < unacceptable_index
-  //            同时 first_index + data.size() > unacceptable_index，那么保留[first_index,unacceptable_index)
-  //******这里如果first_index + data.size() = unacceptable_index
-  // 那么data.resize( unacceptable_index - first_index )这一步不会改变data的长度，
-  // 但把is_last_substring置为false了？？？？？
-  else if ( first_index + data.size() >= unacceptable_index ) {
-    is_last_substring = false;
+  // unacceptable_index:Reassembler能够接受的索引上限。只有整个最后片段都在窗口内，才能确定流的结束位置
+  const uint64_t unacceptable_index = expecting_index_ + bytes_writer.available_capacity();
+  if ( is_last_substring && first_index + data.size() <= unacceptable_index ) {
+    last_index_ = first_index + data.size();
+  }
+
+  // 裁掉超出窗口的部分，以及已经推入流中的部分
+  if ( first_index >= unacceptable_index ) {
+    data.clear();
+  } else if ( first_index + data.size() > unacceptable_index ) {
     data.resize( unacceptable_index - first_index );
   }
+  if ( first_index < expecting_index_ ) {
+    const uint64_t duplicated = min<uint64_t>( expecting_index_ - first_index, data.size() );
+    data.erase( 0, duplicated );
+    first_index += duplicated;
+  }
+
+  if ( data.empty() ) {
+    BufferPool::local().release( move( data ) );
+  } else if ( storage_ == Storage::Window ) {
+    stage_bytes( first_index, move( data ) );
+  } else if ( first_index > expecting_index_ ) {
+    cache_bytes( first_index, move( data ) );
+  } else {
+    push_bytes( first_index, move( data ) );
+    flush_buffer();
+  }
 
-  if ( first_index > expecting_index_ )
-    cache_bytes( first_index, move( data ), is_last_substring );
-  else
-    // 这里是不是还要有去重操作？？？？
-    //****** 这里好像默认了first_index + data.size() > expecting_index_
-    push_bytes( first_index, move( data ), is_last_substring );
-  flush_buffer();
+  if ( last_index_.has_value() && expecting_index_ >= *last_index_ ) {
+    bytes_writer.close(); // 关闭写端
+    clear_buffer();       // 清空缓冲区
+  }
 }
 
 uint64_t Reassembler::bytes_pending() const
@@ -37,81 +65,255 @@ uint64_t Reassembler::bytes_pending() const
   return num_bytes_pending_;
 }
 
-void Reassembler::push_bytes( uint64_t first_index, string data, bool is_last_substring )
+void Reassembler::push_bytes( uint64_t first_index, string data )
 {
+  if ( first_index + data.size() <= expecting_index_ ) { // 完全重复的分组
+    BufferPool::local().release( move( data ) );
+    return;
+  }
   if ( first_index < expecting_index_ ) // 部分重复的分组
     data.erase( 0, expecting_index_ - first_index );
   expecting_index_ += data.size();
   output_.writer().push( move( data ) );
-
-  if ( is_last_substring ) {
-    output_.writer().close(); // 关闭写端
-    unordered_bytes_.clear(); // 清空缓冲区
-    num_bytes_pending_ = 0;
-  }
 }
 
-void Reassembler::cache_bytes( uint64_t first_index, string data, bool is_last_substring )
+// 缓存里的片段互不重叠，新片段只裁剪自己：被已有片段盖住的头尾被裁掉，被新片段完全覆盖的旧片段被删除，
+// 已有片段的字节不会被改写或复制。查找和插入都是 O(log n)。
+void Reassembler::cache_bytes( uint64_t first_index, string data )
 {
-  auto end = unordered_bytes_.end();
-  // left 是第一个结束位置大于或等于 first_index 的缓存片段。
-  auto left = lower_bound( unordered_bytes_.begin(), end, first_index, []( auto&& e, uint64_t idx ) -> bool {
-    return idx > ( get<0>( e ) + get<1>( e ).size() );
-  } );
+  const uint64_t next_index = first_index + data.size();
+  auto next = unordered_bytes_.upper_bound( first_index );
 
-  // 返回第一个起始位置大于 first_index + data.size() 的缓存片段的迭代器
-  auto right = upper_bound( left, end, first_index + data.size(), []( uint64_t nxt_idx, auto&& e ) -> bool {
-    return nxt_idx < get<0>( e );
-  } );
-
-  // 处理与 left 片段的关系：检查新片段是否与 left 片段重叠或相邻，并据此调整新片段或跳过插入
-  if ( const uint64_t next_index = first_index + data.size(); left != end ) {
-    auto& [l_point, dat, _] = *left;
-    if ( const uint64_t r_point = l_point + dat.size(); first_index >= l_point && next_index <= r_point )
+  // 处理与前一个片段（起始位置 <= first_index）的关系：完全被覆盖就丢弃，部分重叠就裁掉新片段的开头
+  if ( next != unordered_bytes_.begin() ) {
+    const auto& [l_point, dat] = *prev( next );
+    if ( const uint64_t r_point = l_point + dat.size(); r_point >= next_index ) {
+      BufferPool::local().release( move( data ) );
       return;
-    else if ( next_index < l_point ) {
-      right = left;
-    } else if ( !( first_index <= l_point && r_point <= next_index ) ) {
-      if ( first_index >= l_point ) {
-        data.insert( 0, string_view( dat.c_str(), dat.size() - ( r_point - first_index ) ) );
-      } else {
-        data.resize( data.size() - ( next_index - l_point ) );
-        data.append( dat );
-      }
-      first_index = min( first_index, l_point );
+    } else if ( r_point > first_index ) {
+      data.erase( 0, r_point - first_index );
+      first_index = r_point;
+    }
+  }
+
+  // 处理起始位置落在新片段内的片段：被完全覆盖的删除，伸出新片段之外的那个则裁掉新片段的结尾
+  while ( next != unordered_bytes_.end() && next->first < next_index ) {
+    auto& [l_point, dat] = *next;
+    if ( l_point + dat.size() > next_index ) {
+      data.resize( l_point - first_index );
+      break;
     }
+    unhold( dat.size() );
+    BufferPool::local().release( move( dat ) );
+    next = unordered_bytes_.erase( next );
   }
 
-  // 处理与 prev(right) 片段的关系：如果 right 不是 left（即存在至少一个片段在 left 和 right 之间），
-  // 则检查新片段是否与 prev(right) 片段相邻并可能重叠，并据此合并片段。
-  if ( const uint64_t next_index = first_index + data.size(); right != left && !unordered_bytes_.empty() ) {
-    auto& [l_point, dat, _] = *prev( right );
-    if ( const uint64_t r_point = l_point + dat.size(); r_point > next_index ) {
-      data.resize( data.size() - ( next_index - l_point ) );
-      data.append( dat );
+  // 片段数达到上限：淘汰最远的片段，给更靠前的新片段让位；新片段本身最远就丢弃它
+  if ( unordered_bytes_.size() >= max_fragments_ ) {
+    if ( unordered_bytes_.empty() || prev( unordered_bytes_.end() )->first < first_index ) {
+      BufferPool::local().release( move( data ) );
+      return;
     }
+    drop_farthest();
   }
 
-  // 清理旧片段：删除 left 到 right（不包括 right）之间的所有旧片段，并更新相关计数器和标志。
-  for ( ; left != right; left = unordered_bytes_.erase( left ) ) {
-    num_bytes_pending_ -= get<1>( *left ).size();
-    is_last_substring |= get<2>( *left );
+  // 乱序数据超出共享的内存预算：同样从最远的片段开始修剪，直到预算够用；新片段本身最远就拒收
+  hold( data.size() );
+  while ( lease_.over_limit() ) {
+    if ( unordered_bytes_.empty() || prev( unordered_bytes_.end() )->first < first_index ) {
+      unhold( data.size() );
+      lease_.budget()->record_refused( data.size() );
+      BufferPool::local().release( move( data ) );
+      return;
+    }
+    const uint64_t pruned = drop_farthest();
+    lease_.budget()->record_pruned( pruned );
+    num_bytes_pruned_ += pruned;
   }
 
-  // 在清理后的位置插入新片段，包括其起始索引、数据和 is_last_substring 标志。
-  num_bytes_pending_ += data.size();
-  unordered_bytes_.insert( left, { first_index, move( data ), is_last_substring } );
+  unordered_bytes_.emplace( first_index, move( data ) );
+}
+
+uint64_t Reassembler::drop_farthest()
+{
+  auto farthest = prev( unordered_bytes_.end() );
+  const uint64_t size = farthest->second.size();
+  unhold( size );
+  BufferPool::local().release( move( farthest->second ) );
+  unordered_bytes_.erase( farthest );
+  return size;
+}
+
+void Reassembler::hold( uint64_t bytes )
+{
+  num_bytes_pending_ += bytes;
+  lease_.grow( bytes );
+}
+
+void Reassembler::unhold( uint64_t bytes )
+{
+  num_bytes_pending_ -= bytes;
+  lease_.shrink( bytes );
 }
 
 void Reassembler::flush_buffer()
 {
   while ( !unordered_bytes_.empty() ) {
-    auto& [idx, dat, last] = unordered_bytes_.front();
-    if ( idx > expecting_index_ )
-      break;                          // 乱序的，不做任何动作
-    num_bytes_pending_ -= dat.size(); // 数据已经被填补上了，立即推入写端
-    push_bytes( idx, move( dat ), last );
-    if ( !unordered_bytes_.empty() )
-      unordered_bytes_.pop_front();
+    auto front = unordered_bytes_.begin();
+    if ( front->first > expecting_index_ )
+      break; // 乱序的，不做任何动作
+    auto node = unordered_bytes_.extract( front );
+    unhold( node.mapped().size() ); // 数据已经被填补上了，立即推入写端
+    push_bytes( node.key(), move( node.mapped() ) );
+  }
+}
+
+size_t Reassembler::fragments_pending() const
+{
+  if ( storage_ == Storage::Fragments ) {
+    return unordered_bytes_.size();
+  }
+  // 每一段的开头是前一位为 0 的 1；位图是环形的，第一个字的“前一位”是最后一个字的最高位
+  size_t runs = 0;
+  uint64_t carry = received_.back() >> 63;
+  for ( const uint64_t word : received_ ) {
+    runs += popcount( word & ~( ( word << 1 ) | carry ) );
+    carry = word >> 63;
+  }
+  return runs;
+}
+
+// 窗口 [expecting_index_, expecting_index_ + available_capacity) 正好是写端预留空间对应的位置，
+// 乱序字节直接写进去，等前缀连续后再 commit，全程不需要额外的缓冲区
+void Reassembler::stage_bytes( uint64_t first_index, string data )
+{
+  Writer& bytes_writer = output_.writer();
+  const uint64_t offset = first_index - expecting_index_;
+  const auto space = bytes_writer.reserve( offset + data.size() );
+  memcpy( space.data() + offset, data.data(), data.size() );
+  num_bytes_pending_ += mark_received( first_index, first_index + data.size() );
+  BufferPool::local().release( move( data ) );
+
+  if ( const uint64_t ready = take_contiguous( expecting_index_ ) ) {
+    bytes_writer.commit( ready );
+    expecting_index_ += ready;
+    num_bytes_pending_ -= ready;
+  }
+}
+
+uint64_t Reassembler::mark_received( uint64_t begin, uint64_t end )
+{
+  const uint64_t mask = received_.size() * 64 - 1;
+  uint64_t newly_received = 0;
+  while ( begin < end ) {
+    const uint64_t bit = begin & mask;
+    const uint64_t len = min( 64 - bit % 64, end - begin );
+    const uint64_t bits = ( len == 64 ? ~uint64_t {} : ( uint64_t { 1 } << len ) - 1 ) << ( bit % 64 );
+    uint64_t& word = received_[bit / 64];
+    newly_received += popcount( bits & ~word );
+    word |= bits;
+    begin += len;
+  }
+  return newly_received;
+}
+
+uint64_t Reassembler::take_contiguous( uint64_t begin )
+{
+  const uint64_t mask = received_.size() * 64 - 1;
+  uint64_t taken = 0;
+  while ( taken <= mask ) {
+    const uint64_t bit = ( begin + taken ) & mask;
+    uint64_t& word = received_[bit / 64];
+    // 从 bit 开始连续 1 的个数；右移后高位补 0，所以最多数到这个字的末尾
+    const uint64_t run = countr_one( word >> ( bit % 64 ) );
+    if ( run == 0 ) {
+      break;
+    }
+    word &= ~( ( run == 64 ? ~uint64_t {} : ( uint64_t { 1 } << run ) - 1 ) << ( bit % 64 ) );
+    taken += run;
+    if ( bit % 64 + run < 64 ) {
+      break; // 遇到了一个还没收到的字节
+    }
+  }
+  return taken;
+}
+
+optional<Reassembler::Range> Reassembler::next_pending_range( uint64_t from ) const
+{
+  if ( storage_ == Storage::Window ) {
+    const uint64_t window_end = expecting_index_ + output_.writer().available_capacity();
+    uint64_t begin = max( from, expecting_index_ );
+    begin += count_run( begin, window_end, false );
+    if ( begin >= window_end ) {
+      return nullopt;
+    }
+    return Range { begin, begin + count_run( begin, window_end, true ) };
+  }
+
+  auto it = unordered_bytes_.lower_bound( from );
+  if ( it == unordered_bytes_.end() ) {
+    return nullopt;
+  }
+  Range range { it->first, it->first + it->second.size() };
+  for ( ++it; it != unordered_bytes_.end() && it->first == range.end; ++it ) {
+    range.end += it->second.size();
+  }
+  return range;
+}
+
+optional<Reassembler::Range> Reassembler::pending_range( uint64_t index ) const
+{
+  if ( storage_ == Storage::Window ) {
+    for ( auto range = next_pending_range( expecting_index_ ); range.has_value() && range->begin <= index;
+          range = next_pending_range( range->end ) ) {
+      if ( index < range->end ) {
+        return range;
+      }
+    }
+    return nullopt;
+  }
+
+  auto it = unordered_bytes_.upper_bound( index );
+  if ( it == unordered_bytes_.begin() || prev( it )->first + prev( it )->second.size() <= index ) {
+    return nullopt;
+  }
+  // 从包含 index 的片段出发，向两边合并相邻的片段
+  auto first = prev( it );
+  Range range { first->first, first->first + first->second.size() };
+  while ( first != unordered_bytes_.begin()
+          && prev( first )->first + prev( first )->second.size() == range.begin ) {
+    range.begin = ( --first )->first;
+  }
+  for ( ; it != unordered_bytes_.end() && it->first == range.end; ++it ) {
+    range.end += it->second.size();
+  }
+  return range;
+}
+
+uint64_t Reassembler::count_run( uint64_t begin, uint64_t end, bool received ) const
+{
+  const uint64_t mask = received_.size() * 64 - 1;
+  uint64_t run = 0;
+  while ( begin + run < end ) {
+    const uint64_t bit = ( begin + run ) & mask;
+    const uint64_t word = received ? received_[bit / 64] : ~received_[bit / 64];
+    // 右移后高位补 0，所以最多数到这个字的末尾
+    const uint64_t len = countr_one( word >> ( bit % 64 ) );
+    run += len;
+    if ( bit % 64 + len < 64 ) {
+      break;
+    }
+  }
+  return min( run, end - begin );
+}
+
+void Reassembler::clear_buffer()
+{
+  fill( received_.begin(), received_.end(), 0 );
+  for ( auto& [_, dat] : unordered_bytes_ ) {
+    unhold( dat.size() );
+    BufferPool::local().release( move( dat ) );
   }
+  unordered_bytes_.clear();
+  num_bytes_pending_ = 0;
 }
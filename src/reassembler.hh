@@ -1,33 +1,84 @@
 #pragma once
 
 #include "byte_stream.hh"
+#include "reassembly_budget.hh"
 
-#include <list>
+#include <cstddef>
+#include <map>
+#include <optional>
 #include <string>
-#include <tuple>
+#include <vector>
 
 class Reassembler
 {
 public:
+  static constexpr size_t DEFAULT_MAX_FRAGMENTS = 4096; // 默认最多缓存的乱序片段数
 
-  explicit Reassembler( ByteStream&& output ) : output_( std::move( output ) ) {}
+  // 乱序数据的存放方式
+  enum class Storage
+  {
+    Fragments, // 按片段缓存在有序表里，内存随乱序数据的多少增减
+    Window,    // 直接写进输出流环形缓冲区里预留的空间，用位图记录哪些字节已经收到；不再分配内存
+  };
+
+  // 缓存的乱序片段计入 budget（Window 模式的空间是预先分配的，不计入）；传 nullptr 表示不受预算限制
+  explicit Reassembler( ByteStream&& output,
+                        size_t max_fragments = DEFAULT_MAX_FRAGMENTS,
+                        Storage storage = Storage::Fragments,
+                        ReassemblyBudget* budget = &ReassemblyBudget::global() );
 
   void insert( uint64_t first_index, std::string data, bool is_last_substring );
 
   uint64_t bytes_pending() const;
 
+  // 当前缓存的乱序片段数（Window 模式下是位图里连续已收到的段数）
+  size_t fragments_pending() const;
+
+  // 因为超出内存预算而被修剪掉的乱序字节总数（对端之后会重传它们）
+  uint64_t bytes_pruned() const { return num_bytes_pruned_; }
+
+  // 缓存的一段连续字节 [begin, end)，以流索引计
+  struct Range
+  {
+    uint64_t begin;
+    uint64_t end;
+  };
+
+  // 起点不小于 from 的第一段缓存字节（相邻的片段合并成一段），用来生成 SACK 块
+  std::optional<Range> next_pending_range( uint64_t from ) const;
+
+  // 包含 index 的那一段缓存字节
+  std::optional<Range> pending_range( uint64_t index ) const;
+
   Reader& reader() { return output_.reader(); }
   const Reader& reader() const { return output_.reader(); }
 
   const Writer& writer() const { return output_.writer(); }
 
 private:
-  void push_bytes( uint64_t first_index, std::string data, bool is_last_substring );
-  void cache_bytes( uint64_t first_index, std::string data, bool is_last_substring );
-  void flush_buffer(); // 刷新缓冲区，把能推入的数据推入流中
-
-  std::list<std::tuple<uint64_t, std::string, bool>> unordered_bytes_ {}; // 一个有序的、无重复的缓冲区
-  uint64_t num_bytes_pending_ {};                                         // 当前存储的字节数
-  uint64_t expecting_index_ {};                                           // 表示期待下一个字节的序号
-  ByteStream output_; 
+  void push_bytes( uint64_t first_index, std::string data );
+  void cache_bytes( uint64_t first_index, std::string data );
+  void flush_buffer();           // 刷新缓冲区，把能推入的数据推入流中
+  void clear_buffer();           // 丢弃所有缓存的片段
+  uint64_t drop_farthest();      // 丢弃最远的片段，返回它的长度
+  void hold( uint64_t bytes );   // 记录新缓存的字节（同时计入预算）
+  void unhold( uint64_t bytes ); // 记录不再缓存的字节
+
+  void stage_bytes( uint64_t first_index, std::string data ); // Window 模式：就地写入并推进连续前缀
+  uint64_t mark_received( uint64_t begin, uint64_t end );     // 位图置位，返回新收到的字节数
+  uint64_t take_contiguous( uint64_t begin );                 // 取走从 begin 开始连续收到的字节
+
+  // Window 模式：[begin, end) 中从 begin 开始连续收到（received 为 false 时是连续没收到）的字节数
+  uint64_t count_run( uint64_t begin, uint64_t end, bool received ) const;
+
+  Storage storage_;
+  std::map<uint64_t, std::string> unordered_bytes_ {}; // 按起始序号排序、互不重叠的乱序片段
+  size_t max_fragments_;                               // 缓存片段数的上限
+  std::vector<uint64_t> received_ {};                  // Window 模式：以流序号取模为下标的位图
+  ReassemblyBudget::Lease lease_;                      // 缓存的字节在共享内存预算中占用的份额
+  uint64_t num_bytes_pruned_ {};                       // 因内存预算被修剪的字节数
+  uint64_t num_bytes_pending_ {};                      // 当前存储的字节数
+  uint64_t expecting_index_ {};                        // 表示期待下一个字节的序号
+  std::optional<uint64_t> last_index_ {};              // 流的结束位置，收到最后一个片段后才知道
+  ByteStream output_;
 };
@@ -40,7 +40,11 @@ void Router::route()
         continue;              // 无法路由或 ttl 为 0 的数据报直接抛弃
       }
       --dgram.header.ttl;
-      //  由于ttl修改了，需要调用 compute_checksum() 方法以重新计算数据报的校验和
+      //  队列超过阈值：能理解 ECN 的数据报标记为 CE
+      if ( ecn_threshold_.has_value() && incoming_dgrams.size() > *ecn_threshold_
+           && dgram.header.ecn() != IPv4Header::ECN_NOT_ECT )
+        dgram.header.set_ecn( IPv4Header::ECN_CE );
+      //  由于ttl和ECN标记修改了，需要调用 compute_checksum() 方法以重新计算数据报的校验和
       dgram.header.compute_checksum();
       //  解构 table_iter 指向的路由条目
       //  获取该数据报应该发送到的网络接口编号interface_num、下一跳地址network_addr
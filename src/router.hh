@@ -37,6 +37,10 @@ public:
   //  不能匹配的就丢弃
   void route();
 
+  //  ECN 标记（RFC 3168）：一个接口上等待转发的数据报超过 threshold 个时，把其中 ECN-capable 的标记为 CE，
+  //  通知发送方降低速率，而不是等队列更长了再丢包。按瞬时队列长度标记，和 DCTCP 要求的一样
+  void set_ecn_threshold( std::optional<size_t> threshold ) { ecn_threshold_ = threshold; }
+
 private:
   struct prefix_info
   {
@@ -73,4 +77,7 @@ private:
 
   //  存储一组指向NetworkInterface的shared_ptr
   std::vector<std::shared_ptr<NetworkInterface>> _interfaces {};
+
+  //  标记 CE 的队列长度阈值，没有值时不标记
+  std::optional<size_t> ecn_threshold_ {};
 };
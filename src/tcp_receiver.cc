@@ -21,10 +21,18 @@ void TCPReceiver::receive( TCPSenderMessage message )
     //查看SYN的值，判断这个首次消息是否合法
     if ( !message.SYN )
       return;
-    //如果合法，则设置ISN_为message.seqno
+    //如果合法，则设置ISN_为message.seqno，并记下对端是否允许 SACK、是否支持窗口缩放、是否请求了 ECN
     ISN_ = message.seqno;
+    peer_sack_permitted_ = message.SACK_permitted;
+    peer_window_scale_ = message.window_scale.has_value();
+    peer_ecn_ = message.ECN;
   }
 
+  //ECN 回显只看占用序号的报文段：纯 ACK 不是 ECN-capable 的，不会被标记。
+  //经典方式下 CWR 说明发送方已经降窗，停止回显，除非这个报文段本身又被标记了
+  if ( ecn_ != ECNEcho::None && peer_ecn_ && message.sequence_length() > 0 )
+    ece_ = message.CE || ( ecn_ == ECNEcho::UntilCWR && ece_ && !message.CWR );
+
   //根据ISN_和checkpoint计算绝对序列号计算message的绝对序列号abso_seqno_
   const uint64_t abso_seqno_ = message.seqno.unwrap( *ISN_, checkpoint );
 
@@ -32,7 +40,13 @@ void TCPReceiver::receive( TCPSenderMessage message )
   //当 abso_seqno_ 为 0 时，表示接收的消息是流的第一个部分。此时，流索引也是 0，因此可以直接插入
   //当 abso_seqno_ 不为 0 时，表示已经有数据接收过，流索引应为 abso_seqno_ - 1。
   //这样插入的负载将正确地放置在流的前一个位置，确保数据流的顺序性。
-  reassembler_.insert( abso_seqno_ == 0 ? abso_seqno_ : abso_seqno_ - 1, move( message.payload ), message.FIN );
+  const uint64_t stream_index = abso_seqno_ == 0 ? abso_seqno_ : abso_seqno_ - 1;
+  const bool has_payload = !message.payload.empty();
+  reassembler_.insert( stream_index, move( message.payload ), message.FIN );
+
+  //记录还停留在乱序缓存里的最新报文段
+  if ( has_payload && stream_index > reassembler_.writer().bytes_pushed() )
+    latest_out_of_order_ = stream_index;
 }
 
 TCPReceiverMessage TCPReceiver::send() const
@@ -40,9 +54,8 @@ TCPReceiverMessage TCPReceiver::send() const
   //checkpoint 表示到正在期待的下一个字节的序号
   const uint64_t checkpoint = reassembler_.writer().bytes_pushed() + ISN_.has_value();
 
-  //计算window_size
-  const uint64_t capacity = reassembler_.writer().available_capacity();
-  const uint16_t wnd_size = capacity > UINT16_MAX ? UINT16_MAX : capacity;
+  //计算window_size：启用窗口缩放后以 2^shift 字节为单位
+  const uint16_t wnd_size = window() >> scale();
 
   //处理初始序列号的情况：
   //将返回一个 TCPReceiverMessage，
@@ -52,7 +65,53 @@ TCPReceiverMessage TCPReceiver::send() const
 
   //处理 ISN 存在的情况：
   //通过ISN_、checkpoint、reassembler_.writer().is_closed（）计算ackno
-  return { Wrap32::wrap( checkpoint + reassembler_.writer().is_closed(), *ISN_ ),
-           wnd_size,
-           reassembler_.writer().has_error() };
+  TCPReceiverMessage msg { Wrap32::wrap( checkpoint + reassembler_.writer().is_closed(), *ISN_ ),
+                           wnd_size,
+                           reassembler_.writer().has_error() };
+  if ( sack_ && peer_sack_permitted_ )
+    fill_sack_blocks( msg );
+  msg.ECE = ece_;
+  return msg;
+}
+
+uint64_t TCPReceiver::window() const
+{
+  uint64_t capacity = reassembler_.writer().available_capacity();
+
+  //糊涂窗口避免（RFC 1122 4.2.3.3）：应用读走数据时窗口右沿不跟着一点点前移，
+  //而是攒够 min(缓冲区的一半, MSS) 字节再整段前移，免得宣告只装得下几个字节的窗口，引得发送方发小报文段。
+  //右沿只在读走的字节数跨过 step 的整数倍时前移，所以不用记住上次宣告的窗口，也不会回缩
+  if ( sws_mss_ > 0 ) {
+    const uint64_t buffer = capacity + reassembler_.reader().bytes_buffered();
+    const uint64_t step = min( buffer / 2, sws_mss_ );
+    const uint64_t held_back = step > 0 ? reassembler_.reader().bytes_popped() % step : 0;
+    capacity = capacity > held_back ? capacity - held_back : 0;
+  }
+
+  //启用窗口缩放后以 2^shift 字节为单位宣告，向下取整
+  const uint8_t shift = scale();
+  return min<uint64_t>( capacity, uint64_t { UINT16_MAX } << shift ) >> shift << shift;
+}
+
+void TCPReceiver::fill_sack_blocks( TCPReceiverMessage& msg ) const
+{
+  //流索引转换成序号时要加上 SYN 占用的一个序号
+  const auto add_block = [&]( const Reassembler::Range& range ) {
+    msg.sack_blocks.at( msg.num_sack_blocks++ )
+      = { Wrap32::wrap( range.begin + 1, *ISN_ ), Wrap32::wrap( range.end + 1, *ISN_ ) };
+  };
+
+  //最近收到的报文段所在的块排在第一个，其余的块按位置从近到远排列，让发送方先补最早的空洞
+  optional<Reassembler::Range> latest;
+  if ( latest_out_of_order_.has_value() )
+    latest = reassembler_.pending_range( *latest_out_of_order_ );
+  if ( latest.has_value() )
+    add_block( *latest );
+
+  for ( auto range = reassembler_.next_pending_range( 0 );
+        range.has_value() && msg.num_sack_blocks < TCPReceiverMessage::MAX_SACK_BLOCKS;
+        range = reassembler_.next_pending_range( range->end ) ) {
+    if ( !latest.has_value() || range->begin != latest->begin )
+      add_block( *range );
+  }
 }
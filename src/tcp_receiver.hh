@@ -8,7 +8,30 @@
 class TCPReceiver
 {
 public:
-  explicit TCPReceiver( Reassembler&& reassembler ) : reassembler_( std::move( reassembler ) ) {}
+  //ECN 的回显方式：经典的（RFC 3168）收到 CE 标记之后每个 ACK 都带 ECE，直到发送方回应 CWR；
+  //DCTCP（RFC 8257）的 ECE 只反映刚收到的报文段有没有 CE 标记，发送方据此估计被标记的比例
+  enum class ECNEcho : uint8_t
+  {
+    None,
+    UntilCWR,
+    PerSegment,
+  };
+
+  //sack 为 true 时，如果对端的 SYN 也允许 SACK，send() 会报告乱序缓存中的字节块（RFC 2018）
+  //window_shift 有值时，如果对端的 SYN 也带有窗口缩放选项，send() 报告的窗口以 2^window_shift 字节为单位（RFC 7323）
+  //ecn 不为 None 时，如果对端的 SYN 也请求了 ECN，send() 按这种方式回显 CE 标记
+  //sws_mss 不为 0 时启用接收方的糊涂窗口避免，窗口每次至少打开 min(缓冲区的一半, sws_mss) 字节
+  explicit TCPReceiver( Reassembler&& reassembler,
+                        bool sack = false,
+                        std::optional<uint8_t> window_shift = {},
+                        ECNEcho ecn = ECNEcho::None,
+                        uint64_t sws_mss = 0 )
+    : reassembler_( std::move( reassembler ) )
+    , sack_( sack )
+    , window_shift_( window_shift )
+    , ecn_( ecn )
+    , sws_mss_( sws_mss )
+  {}
 
   //该方法接收 TCPSenderMessage 类型的消息，
   //并将其有效负载插入到 Reassembler 中，确保数据按正确的流索引进行重组。
@@ -17,6 +40,9 @@ public:
   //该方法生成并返回一个 TCPReceiverMessage，用于发送给对端的 TCP 发送者
   TCPReceiverMessage send() const;
 
+  //send() 宣告的窗口大小，以字节计
+  uint64_t window() const;
+
   //这些方法提供了对重组器状态的访问，以便进行读取和写入操作
   const Reassembler& reassembler() const { return reassembler_; }
   Reader& reader() { return reassembler_.reader(); }
@@ -24,7 +50,26 @@ public:
   const Writer& writer() const { return reassembler_.writer(); }
 
 private:
+  //把乱序缓存中的字节块填进 msg 的 SACK 选项
+  void fill_sack_blocks( TCPReceiverMessage& msg ) const;
+  //宣告的窗口要右移的位数：两端都带窗口缩放选项时才不为 0
+  uint8_t scale() const { return window_shift_.has_value() && peer_window_scale_ ? *window_shift_ : 0; }
+
   Reassembler reassembler_;
+  //本端是否启用 SACK，以及对端的 SYN 是否带有 SACK-permitted 选项
+  bool sack_;
+  bool peer_sack_permitted_ {};
+  //本端宣告的窗口缩放位数，以及对端的 SYN 是否带有窗口缩放选项（两端都带才启用）
+  std::optional<uint8_t> window_shift_;
+  bool peer_window_scale_ {};
+  //本端的 ECN 回显方式，对端的 SYN 是否请求了 ECN，以及下一个 ACK 要不要带 ECE
+  ECNEcho ecn_;
+  bool peer_ecn_ {};
+  bool ece_ {};
+  //糊涂窗口避免用的 MSS，为 0 时不启用
+  uint64_t sws_mss_;
+  //最近一个乱序到达的报文段的流索引，它所在的块要排在 SACK 选项的第一个
+  std::optional<uint64_t> latest_out_of_order_ {};
   //表示接收方是否已经接收到有效的初始序列号。
   std::optional<Wrap32> ISN_ {};
 };
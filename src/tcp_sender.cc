@@ -1,6 +1,8 @@
 #include "tcp_sender.hh"
+#include "buffer_pool.hh"
 #include "tcp_config.hh"
 #include <algorithm>
+#include <utility>
 
 using namespace std;
 
@@ -12,7 +14,7 @@ RetransmissionTimer& RetransmissionTimer::active() noexcept
 
 RetransmissionTimer& RetransmissionTimer::timeout() noexcept
 {
-  RTO_ <<= 1;
+  RTO_ = RTO_ > max_RTO_ / 2 ? max_RTO_ : RTO_ * 2;
   return *this;
 }
 
@@ -28,80 +30,204 @@ RetransmissionTimer& RetransmissionTimer::tick( uint64_t ms_since_last_tick ) no
   return *this;
 }
 
+RTTEstimator::RTTEstimator( uint64_t initial_RTO_ms, uint64_t min_RTO_ms, uint64_t max_RTO_ms )
+  : min_RTO_( min_RTO_ms )
+  , max_RTO_( max( min_RTO_ms, max_RTO_ms ) )
+  , RTO_( clamp( initial_RTO_ms, min_RTO_, max_RTO_ ) )
+{}
+
+void RTTEstimator::sample( uint64_t rtt_ms )
+{
+  min_rtt_ = min( min_rtt_, rtt_ms );
+  if ( !has_sample_ ) { // 第一个样本：SRTT = R，RTTVAR = R/2
+    srtt_x8_ = rtt_ms << 3;
+    rttvar_x4_ = rtt_ms << 1;
+    has_sample_ = true;
+  } else { // RTTVAR = 3/4 RTTVAR + 1/4 |SRTT - R|（用更新前的 SRTT），SRTT = 7/8 SRTT + 1/8 R
+    const uint64_t srtt = srtt_x8_ >> 3;
+    rttvar_x4_ += ( srtt > rtt_ms ? srtt - rtt_ms : rtt_ms - srtt ) - ( rttvar_x4_ >> 2 );
+    srtt_x8_ += rtt_ms - srtt;
+  }
+  // RTO = SRTT + max(G, 4 * RTTVAR)
+  RTO_ = clamp( smoothed_RTT_ms() + max( CLOCK_GRANULARITY_MS, rttvar_x4_ ), min_RTO_, max_RTO_ );
+}
+
+TCPSender::TCPSender( ByteStream&& input, const TCPConfig& cfg )
+  : TCPSender( std::move( input ), cfg.isn, cfg.rt_timeout )
+{
+  //  探测时从保守的 MAX_PAYLOAD_SIZE 开始，逐步试到配置的 MSS
+  MSS_ = cfg.mtu_probing ? min<uint64_t>( cfg.mss, TCPConfig::MAX_PAYLOAD_SIZE ) : cfg.mss;
+  announced_MSS_ = cfg.mss;
+  if ( cfg.window_scale )
+    window_shift_ = cfg.recv_window_shift();
+  mtu_probing_ = cfg.mtu_probing;
+  probe_ceiling_ = cfg.mss;
+  congestion_algorithm_ = cfg.congestion_control;
+  congestion_ = make_congestion_controller( congestion_algorithm_, MSS_ );
+  rtt_.emplace( cfg.rt_timeout, cfg.min_rt_timeout, cfg.max_rt_timeout );
+  loss_recovery_ = true;
+  sack_permitted_ = cfg.sack;
+  timestamps_ = cfg.timestamps;
+  nagle_ = !cfg.nodelay;
+  autocork_timeout_ms_ = cfg.autocork_timeout;
+  frto_ = cfg.frto;
+  rack_ = cfg.rack;
+  ecn_ = cfg.ecn_enabled();
+  max_RTO_ms_ = max<uint64_t>( cfg.min_rt_timeout, cfg.max_rt_timeout );
+  timer_ = RetransmissionTimer( rtt_->RTO_ms(), max_RTO_ms_ );
+  //  BBR 按测得的带宽决定发送速率，总是限速发送
+  if ( cfg.pacing || congestion_algorithm_ == TCPConfig::CongestionControl::BBR ) {
+    pacer_.emplace( MSS_ );
+    fixed_pacing_rate_ = cfg.pacing ? cfg.pacing_rate : 0;
+  }
+}
+
 void TCPSender::push( const TransmitFunction& transmit )
 {
-  /*  input_ 是发送方的数据流
-      bytes_reader 是用来从 input_ 中读取数据的对象 */
-  Reader& bytes_reader = input_.reader();
+  //  拥塞窗口和 RTT 都可能在上一次 push 之后变了
+  pacing_limited_ = false;
+  if ( pacer_ )
+    pacer_->set_rate( pacing_rate() );
 
-  /*  bytes_reader.is_finished() 返回 true（表示流中的数据已经读完）时
-      fin_flag_ 就会被设置为 true，表示 TCP 连接应该进入关闭阶段，并且需要发送一个带有 FIN 标志的报文 */
-  fin_flag_ |= bytes_reader.is_finished(); 
+  const bool flush = exchange( uncork_flush_, false );
 
-  //  检查连接是否已经结束
-  if ( sent_fin_ )
-    return; 
+  //  恢复期间先补上空洞，然后才发送新数据
+  if ( probe_lost_ ) {
+    resend_probe( transmit );
+    probe_lost_ = false;
+  }
+  if ( recovery_ || rto_recovery_ || rack_lost_ > 0 )
+    retransmit_lost( transmit );
 
-  //  计算窗口大小
-  const size_t window_size = wnd_size_ == 0 ? 1 : wnd_size_;
+  const uint64_t window_size = send_window();
 
-  //  不断从input_读取数据 放入 payload
-  for ( string payload {}; num_bytes_in_flight_ < window_size && !sent_fin_; payload.clear() ) {
-    //  从 input_ 流中“窥视”当前可用的数据，并将其存储在 bytes_view 
-    string_view bytes_view = bytes_reader.peek();
+  while ( !sent_fin_ && num_bytes_in_flight_ < window_size ) {
+    const uint64_t room = window_size - num_bytes_in_flight_;
+    const bool SYN = !sent_syn_;
+    const uint64_t unsent = unsent_bytes();
 
-    //  如果 连接已建立 (sent_syn_) 且 当前流中没有数据可读 (bytes_view.empty())，并且不需要发送 FIN 报文 (!fin_flag_)
-    if ( sent_syn_ && bytes_view.empty() && !fin_flag_ )
-      break;
+    //  路径 MTU 探测：没有探测在途、也不在恢复中时，如果数据和窗口都够，就用一个更大的报文段试探
+    uint64_t segment_size = MSS_;
+    const uint64_t probe = probe_size();
+    if ( probe > 0 && !SYN && room >= probe && unsent >= probe )
+      segment_size = probe;
+
+    //  payload 的长度受报文长度限制、窗口上限和流里还没发送的字节数限制
+    const uint64_t payload_size = min( { segment_size, room - SYN, unsent } );
+
+    //  只剩下不足一个 MSS 的数据（应用写得少，而不是窗口小）时可以先不发，等它攒大一些
+    if ( !SYN && payload_size > 0 && payload_size < MSS_ && payload_size == unsent && !input_.writer().is_closed()
+         && !flush && hold_small_segment() ) {
+      app_limited_ = true;
+      app_limited_until_ = max<uint64_t>( delivered_ + num_bytes_in_flight_, 1 );
+      return;
+    }
 
-    //  组装payload，直到达到 报文长度限制 或 窗口上限
-    while ( payload.size() + num_bytes_in_flight_ + ( !sent_syn_ ) < window_size
-            && payload.size() < TCPConfig::MAX_PAYLOAD_SIZE ) { 
-      //  如果所有可用的数据都已经被读取
-      if ( bytes_view.empty() || fin_flag_ )
-        break; 
-
-      //  如果当前准备组装进 payload 的 bytes_view.size() > available_size,则需要截断 bytes_view
-      if ( const uint64_t available_size
-           = min( TCPConfig::MAX_PAYLOAD_SIZE - payload.size(),
-                  window_size - ( payload.size() + num_bytes_in_flight_ + ( !sent_syn_ ) ) );
-           bytes_view.size() > available_size ) 
-        //  移除 bytes_view 末尾超出 available_size 的部分,仅保留前面 available_size 个字符
-        bytes_view.remove_suffix( bytes_view.size() - available_size );
-
-      //  更新payload
-      payload.append( bytes_view );
-      bytes_reader.pop( bytes_view.size() );
-
-      //  从流中弹出字符后要检查流是否关闭
-      fin_flag_ |= bytes_reader.is_finished();
-      bytes_view = bytes_reader.peek();
-    }
-
-    //  生成一个TCPSenderMessage msg
-    auto& msg = outstanding_bytes_.emplace(
-      make_message( next_seqno_, move( payload ), sent_syn_ ? syn_flag_ : true, fin_flag_ ) );
-    
-    /*  如果SYN 已经发送过，则margin = 1
-        如果SYN 没有发送过，则margin = 0  */
-    const size_t margin = sent_syn_ ? syn_flag_ : 0;
-
-    //  决定当前组装的msg 能否发送 FIN标志
-    if ( fin_flag_ && ( msg.sequence_length() - margin ) + num_bytes_in_flight_ > window_size )
-      msg.FIN = false;    
-    else if ( fin_flag_ ) 
-      sent_fin_ = true;
-      
-    // 最后再计算真实的报文长度
-    const size_t correct_length = msg.sequence_length() - margin;
-
-    num_bytes_in_flight_ += correct_length;
-    next_seqno_ += correct_length;
+    //  流已经结束、数据都已发出并且窗口还有空间时，带上 FIN
+    const bool FIN = input_.writer().is_closed() && payload_size == unsent && SYN + payload_size < room;
+    OutstandingSegment seg { .seqno = next_seqno_,
+                             .length = SYN + payload_size + FIN,
+                             .SYN = SYN,
+                             .FIN = FIN,
+                             .sent_ms = now_ms_,
+                             .retransmitted = false,
+                             .sacked = false };
+
+    //  没有任何需要发送的序号：发送方受限于应用，而不是窗口
+    if ( seg.length == 0 ) {
+      app_limited_ = true;
+      app_limited_until_ = max<uint64_t>( delivered_ + num_bytes_in_flight_, 1 );
+      return;
+    }
+
+    //  令牌不够发这个报文段时先停下，等 tick() 补充令牌后再继续
+    if ( pacer_ && !pacer_->can_send( seg.length ) ) {
+      pacing_limited_ = true;
+      app_limited_ = false;
+      return;
+    }
+
+    stamp_transmission( seg );
     sent_syn_ = true;
-    transmit( msg );
-    if ( correct_length != 0 )
-      timer_.active();
+    sent_fin_ = FIN;
+    if ( payload_size == unsent )
+      corked_since_ms_.reset();
+    num_bytes_in_flight_ += seg.length;
+    next_seqno_ += seg.length;
+    transmit_segment( seg, transmit, seg.payload_size() > 0 && exchange( send_cwr_, false ) );
+    timer_.active();
+    if ( pacer_ )
+      pacer_->on_send( seg.length );
+    if ( payload_size > MSS_ ) {
+      probe_ = MTUProbe { seg.seqno, payload_size };
+      ++stats_.mtu_probes;
+    }
+    if ( recovery_ ) {
+      recovery_->prr_out += seg.length;
+      recovery_->sndcnt -= min( recovery_->sndcnt, seg.length );
+    }
+    if ( timeout_check_ )
+      timeout_check_->new_data_budget -= min( timeout_check_->new_data_budget, seg.length );
+    tlp_budget_ -= min( tlp_budget_, seg.length );
+    outstanding_bytes_.push_back( seg );
+    schedule_loss_probe();
+  }
+  app_limited_ = false;
+}
+
+bool TCPSender::hold_small_segment()
+{
+  if ( corked_ ) {
+    if ( !corked_since_ms_ )
+      corked_since_ms_ = now_ms_;
+    return now_ms_ - *corked_since_ms_ < autocork_timeout_ms_;
   }
+  return nagle_ && num_bytes_in_flight_ > 0;
+}
+
+void TCPSender::set_corked( bool corked )
+{
+  uncork_flush_ = corked_ && !corked;
+  corked_ = corked;
+  corked_since_ms_.reset();
+}
+
+uint64_t TCPSender::unsent_bytes() const
+{
+  return input_.writer().bytes_pushed() - ( next_seqno_ - sent_syn_ - sent_fin_ );
+}
+
+void TCPSender::transmit_segment( const OutstandingSegment& seg, const TransmitFunction& transmit, bool CWR ) const
+{
+  //  payload 在字节流里的位置：SYN 占用序号 0，流的第一个字节是序号 1；已经确认的字节都弹出了
+  const uint64_t offset = seg.seqno + seg.SYN - 1 - input_.reader().bytes_popped();
+  TCPSenderMessage msg
+    = make_message( seg.seqno, BufferPool::local().acquire( seg.payload_size() ), seg.SYN, seg.FIN );
+  msg.payload.append( input_.reader().peek().substr( offset, seg.payload_size() ) );
+  //  只有数据报文段是 ECN-capable 的；重传也是（RFC 8311 放宽了 RFC 3168 的限制）
+  msg.ECT = ecn_ && seg.payload_size() > 0;
+  msg.CWR = CWR;
+  transmit( msg );
+  BufferPool::local().release( move( msg.payload ) );
+}
+
+uint64_t TCPSender::send_window() const
+{
+  //  接收方窗口，为 0 时按 1 处理，以便发送零窗口探测
+  const uint64_t receive_window = wnd_size_ == 0 ? 1 : wnd_size_;
+  if ( !congestion_ )
+    return receive_window;
+
+  //  快速恢复期间由 PRR 决定还能发送多少
+  if ( recovery_ )
+    return min( receive_window, num_bytes_in_flight_ + recovery_->sndcnt );
+
+  //  有限发送（RFC 3042）：前两个重复 ACK 各允许在拥塞窗口之外再发一个新的报文段；
+  //  F-RTO 超时之后的第一个 ACK 也允许在拥塞窗口之外发两个新的报文段，尾部丢包探测允许一个
+  const uint64_t limited_transmit = min<uint64_t>( dup_acks_, 2 ) * MSS_;
+  const uint64_t frto_budget = timeout_check_ ? timeout_check_->new_data_budget : 0;
+  const uint64_t probe_budget = num_bytes_in_flight_ + max( frto_budget, tlp_budget_ );
+  return min( receive_window, max( congestion_->cwnd() + limited_transmit, probe_budget ) );
 }
 
 TCPSenderMessage TCPSender::make_empty_message() const
@@ -111,63 +237,626 @@ TCPSenderMessage TCPSender::make_empty_message() const
 
 void TCPSender::receive( const TCPReceiverMessage& msg )
 {
-  wnd_size_ = msg.window_size;
-  //  没有 ackno 的报文通常不会确认新的字节，而可能只是更新窗口大小
-  if ( !msg.ackno.has_value() ) {
-    if ( msg.window_size == 0 )
-      input_.set_error();
-    return;
+  if ( msg.RST ) {
+    input_.set_error();
   }
 
+  const uint64_t prior_window = wnd_size_;
+  wnd_size_ = uint64_t { msg.window_size } << peer_window_shift_;
+  //  没有 ackno 的报文不会确认新的字节，而可能只是更新窗口大小
+  if ( !msg.ackno.has_value() )
+    return;
+
   const uint64_t excepting_seqno = msg.ackno->unwrap( isn_, next_seqno_ );
   /*  如果接收方的确认号（ackno）超出发送方当前的发送范围
       这个确认就没有意义了，发送方就不需要对这个确认进行进一步处理，因此直接返回。  */
-  if ( excepting_seqno > next_seqno_ ) 
-    return;                            
+  if ( excepting_seqno > next_seqno_ )
+    return;
 
-  bool is_acknowledged = false; // 用于判断确认是否发生
+  //  只有整个报文段都被确认，才把它移出队列
+  //  RTT 样本取自这次确认的最新报文段。只要确认了重传过的报文段，就无法区分确认的是哪一次发送，
+  //  而且填补空洞之后的确认会把等待重传的时间也算进去，所以整个确认都不采样（Karn 算法）
+  const uint64_t prior_in_flight = num_bytes_in_flight_;
+  optional<uint64_t> rtt_sample;
+  bool acked_retransmission = false;
+  uint64_t acked_segments = 0;
+  uint64_t acked_sacked = 0;
   while ( !outstanding_bytes_.empty() ) {
-    auto& buffered_msg = outstanding_bytes_.front();
-    
-    /*  1.excepting_seqno <= acked_seqno_ ： 表示接收方除了在outstanding_bytes_中的数据外，其他的所有数据都已经确认。  
-        2.excepting_seqno < final_seqno ： 表示buffered_msg的部分字节未确认 */
-    if ( const uint64_t final_seqno = acked_seqno_ + buffered_msg.sequence_length() - buffered_msg.SYN;
-         excepting_seqno <= acked_seqno_ || excepting_seqno < final_seqno )
-      break; 
+    const OutstandingSegment& seg = outstanding_bytes_.front();
+    if ( seg.end() > excepting_seqno )
+      break;
+    num_bytes_in_flight_ -= seg.length;
+    acked_sacked += seg.sacked ? seg.length : 0;
+    acked_seqno_ = seg.end();
+    ++acked_segments;
+    acked_retransmission |= seg.retransmitted;
+    rtt_sample = acked_retransmission ? nullopt : optional { now_ms_ - seg.sent_ms };
+    if ( !seg.sacked )
+      rate_on_delivered( seg );
+    if ( rack_ && !seg.sacked )
+      rack_on_delivered( seg, msg );
+    rack_lost_ -= seg.lost;
+    //  整个报文段都被确认之后，它的 payload 才从发送缓冲区里弹出
+    input_.reader().pop( seg.payload_size() );
+    outstanding_bytes_.pop_front();
+  }
+  sacked_bytes_ -= acked_sacked;
+  if ( probe_ && acked_seqno_ >= probe_->seqno + probe_->size )
+    on_probe_delivered();
+  const uint64_t acked_bytes = prior_in_flight - num_bytes_in_flight_;
+
+  //  有时间戳时，每个确认了新数据的 ACK 都是一个 RTT 样本，重传过的报文段也不例外：
+  //  回显的是让接收方推进 ackno 的那次发送的时间。比连接开始还早的回显是无效的
+  if ( timestamps_ && msg.timestamp_echo.has_value() && acked_bytes > 0 ) {
+    const uint32_t elapsed = static_cast<uint32_t>( now_ms_ ) - *msg.timestamp_echo;
+    if ( elapsed <= now_ms_ )
+      rtt_sample = elapsed;
+  }
+  const uint64_t newly_sacked = loss_recovery_ ? update_scoreboard( msg ) : 0;
+
+  //  接收方这次新收到的序号数（用于 PRR）：有 SACK 时是新确认的、之前没被 SACK 的加上新被 SACK 的；
+  //  没有 SACK 时，越过空洞的确认要减去之前按重复 ACK 估计已经到达的报文段（第一个被确认的是重传的那个）
+  uint64_t delivered = acked_bytes - acked_sacked + newly_sacked;
+  if ( !peer_sacks_ && acked_segments > 0 ) {
+    const uint64_t counted = min( sacked_out_, acked_segments - 1 );
+    sacked_out_ -= counted;
+    delivered = acked_bytes - min( acked_bytes, counted * MSS_ );
+  }
+  if ( acked_bytes > 0 || newly_sacked > 0 )
+    update_rate_sample( rtt_sample, acked_bytes - acked_sacked + newly_sacked );
+
+  if ( acked_bytes > 0 ) {
+    //  没有估计器时 RTO 恢复为初始值；有估计器时采用新算出的 RTO，
+    //  没有有效样本则保留（可能已经退避过的）当前 RTO，直到确认了没有重传过的数据
+    uint64_t RTO = initial_RTO_ms_;
+    if ( rtt_ ) {
+      if ( rtt_sample.has_value() )
+        rtt_->sample( *rtt_sample );
+      RTO = rtt_sample.has_value() ? rtt_->RTO_ms() : timer_.RTO();
+    }
+    // 因为要重置 RTO 值，故直接更换新对象：如果全部分组都被确认，那就停止计时器，否则就只重启计时器
+    timer_ = RetransmissionTimer( RTO, max_RTO_ms_ );
+    if ( !outstanding_bytes_.empty() )
+      timer_.active();
+    retransmission_cnt_ = 0;
+
+    if ( timeout_check_ )
+      check_spurious_timeout( msg, excepting_seqno );
+
+    if ( recovery_ ) {
+      on_recovery_ack( delivered, excepting_seqno );
+    } else {
+      dup_acks_ = 0;
+      sacked_out_ = 0;
+      //  超时之后的部分确认：超时前发出的数据里多半还有别的空洞，每个 ACK 重传一个，而不是每个 RTO 一个
+      if ( rto_recovery_ )
+        rto_recovery_ = excepting_seqno < recover_;
+      //  SYN 不是数据，只确认了 SYN 的 ACK 不增长拥塞窗口
+      const uint64_t acked_data = acked_bytes - ( acked_seqno_ == acked_bytes );
+      if ( congestion_ && acked_data > 0 ) {
+        congestion_->on_ack( { .now_ms = now_ms_,
+                               .acked_bytes = acked_data,
+                               .prior_in_flight = prior_in_flight,
+                               .app_limited = app_limited_,
+                               .ece = ecn_ && msg.ECE } );
+      }
+      //  ECE：路径上有路由器标记了拥塞。和丢包一样降窗，但不用重传；每个窗口最多一次（RFC 3168 6.1.2）
+      if ( congestion_ && ecn_ && msg.ECE && excepting_seqno > ecn_recover_ && !rto_recovery_ ) {
+        congestion_->on_ecn( prior_in_flight );
+        ecn_recover_ = next_seqno_;
+        send_cwr_ = true;
+        ++stats_.ecn_reductions;
+      }
+    }
+  } else if ( loss_recovery_ && excepting_seqno == acked_seqno_ && !outstanding_bytes_.empty()
+              && wnd_size_ == prior_window ) {
+    //  重复 ACK（RFC 5681）：没有确认新数据，窗口也没有变化，但还有数据在途
+    on_duplicate_ack( delivered );
+  }
+
+  if ( !rack_ )
+    return;
+
+  //  尾部丢包探测有了结果。探测是重传的最后一个报文段时，除非时间戳证明原来的报文段先到了，
+  //  否则就是探测补上了一个丢包，按快速恢复的幅度降窗（RFC 8985 7.4）
+  if ( tlp_ && acked_seqno_ >= tlp_->end ) {
+    const bool original_delivered = timestamps_ && msg.timestamp_echo.has_value()
+                                    && static_cast<int32_t>( *msg.timestamp_echo - tlp_->ts ) < 0;
+    if ( tlp_->retransmitted && !original_delivered && congestion_ && !recovery_ )
+      congestion_->on_loss( prior_in_flight );
+    tlp_.reset();
+  }
+
+  //  按发送时间判断丢失：尾部丢包时等不到三个重复 ACK，一个 SACK 就够了
+  if ( rack_detect_loss() )
+    on_rack_loss( delivered );
+  if ( acked_bytes > 0 || newly_sacked > 0 )
+    schedule_loss_probe();
+}
+
+void TCPSender::check_spurious_timeout( const TCPReceiverMessage& msg, uint64_t ackno )
+{
+  SpuriousTimeoutCheck& check = *timeout_check_;
+  bool spurious = false;
+
+  if ( timestamps_ ) {
+    //  Eifel（RFC 3522）：回显的时间戳早于超时重传，说明这个 ACK 是原来那次发送触发的，原来的报文段没有丢
+    spurious = msg.timestamp_echo.has_value()
+               && static_cast<int32_t>( *msg.timestamp_echo - check.retransmit_ts ) < 0;
+  } else if ( !check.new_data_sent ) {
+    //  F-RTO（RFC 5682）第一个 ACK：确认了超时前发出的全部数据时无法判断，按普通的超时恢复处理；
+    //  否则暂停重传，先在拥塞窗口之外发两个新的报文段，看下一个 ACK 怎么说
+    if ( ackno < recover_ && unsent_bytes() > 0 ) {
+      check.new_data_sent = true;
+      check.new_data_budget = 2 * MSS_;
+      rto_recovery_ = false;
+      return;
+    }
+  } else {
+    //  F-RTO 第二个 ACK：发送新数据之后又确认了新数据，超时前发出的报文段确实到了
+    spurious = true;
+  }
+
+  if ( spurious ) {
+    congestion_->undo( check.prior_cwnd, check.prior_ssthresh );
+    rto_recovery_ = false;
+    ++stats_.spurious_timeouts;
+  }
+  timeout_check_.reset();
+}
+
+void TCPSender::on_duplicate_ack( uint64_t delivered_bytes )
+{
+  ++dup_acks_;
+
+  //  F-RTO：超时之后的第一个 ACK 就是重复 ACK，或者发送新数据之后收到重复 ACK，说明超时是真的，
+  //  回到普通的超时恢复，继续重传超时前发出的数据
+  if ( timeout_check_ && !timestamps_ ) {
+    rto_recovery_ = true;
+    timeout_check_.reset();
+  }
+
+  //  没有 SACK 时，一个重复 ACK 按接收方收到了一个报文段估计
+  if ( !peer_sacks_ ) {
+    sacked_out_ = min<uint64_t>( sacked_out_ + 1, outstanding_bytes_.size() - 1 );
+    delivered_bytes = MSS_;
+  }
+
+  if ( recovery_ ) {
+    update_prr( delivered_bytes );
+    return;
+  }
+
+  //  确认号要到达上一次恢复（或超时）时的最高序号，才能再次进入快速恢复，避免对同一窗口的丢包多次降窗
+  if ( dup_acks_ < DUP_ACK_THRESHOLD || acked_seqno_ < recover_ )
+    return;
+
+  //  丢的是探测报文段：只说明路径 MTU 比它小，不是拥塞的信号，不降窗（RFC 4821 7.5）；
+  //  同一窗口后面的数据引起的重复 ACK 也不再触发快速重传
+  if ( probe_ && outstanding_bytes_.front().seqno == probe_->seqno ) {
+    probe_lost_ = true;
+    recover_ = next_seqno_;
+    dup_acks_ = 0;
+    sacked_out_ = 0;
+    return;
+  }
+
+  enter_recovery( delivered_bytes );
+}
+
+void TCPSender::enter_recovery( uint64_t delivered_bytes )
+{
+  recover_ = next_seqno_;
+  recovery_ = Recovery { .recover_fs = num_bytes_in_flight_ };
+  if ( congestion_ )
+    congestion_->on_loss( num_bytes_in_flight_ );
+  update_prr( delivered_bytes );
+  next_retransmit_ = acked_seqno_;
+  //  恢复期间不做尾部丢包探测，这次的探测也已经不需要再判断了
+  tlp_deadline_ms_.reset();
+  tlp_.reset();
+}
+
+void TCPSender::on_recovery_ack( uint64_t delivered_bytes, uint64_t ackno )
+{
+  //  完全确认：恢复结束，cwnd 停在进入恢复时 on_loss 设置的 ssthresh
+  if ( ackno >= recover_ ) {
+    recovery_.reset();
+    dup_acks_ = 0;
+    sacked_out_ = 0;
+    return;
+  }
+
+  //  部分确认（RFC 6582）：下一个空洞也丢了，下一次 push 立即重传它，不必再等三个重复 ACK
+  dup_acks_ = 0;
+  update_prr( delivered_bytes );
+}
+
+uint64_t TCPSender::update_scoreboard( const TCPReceiverMessage& msg )
+{
+  uint64_t newly_sacked = 0;
+  for ( const SackBlock& block : msg.sack() ) {
+    const uint64_t begin = block.begin.unwrap( isn_, next_seqno_ );
+    const uint64_t end = block.end.unwrap( isn_, next_seqno_ );
+    //  忽略不合理的块：空的、已经确认过的（D-SACK）或者超出已发送范围的
+    if ( begin >= end || begin < acked_seqno_ || end > next_seqno_ )
+      continue;
+    peer_sacks_ = true;
+    highest_sacked_ = max( highest_sacked_, end );
+
+    //  只有整个报文段都落在块内，才算它已经到达
+    auto it = lower_bound( outstanding_bytes_.begin(),
+                           outstanding_bytes_.end(),
+                           begin,
+                           []( const OutstandingSegment& seg, uint64_t seqno ) { return seg.seqno < seqno; } );
+    for ( ; it != outstanding_bytes_.end() && it->end() <= end; ++it ) {
+      if ( !it->sacked ) {
+        it->sacked = true;
+        sacked_bytes_ += it->length;
+        newly_sacked += it->length;
+        rate_on_delivered( *it );
+        if ( rack_ )
+          rack_on_delivered( *it, msg );
+        rack_lost_ -= it->lost;
+        it->lost = false;
+      }
+      if ( probe_ && it->seqno == probe_->seqno )
+        on_probe_delivered();
+    }
+  }
+  return newly_sacked;
+}
+
+void TCPSender::retransmit_lost( const TransmitFunction& transmit )
+{
+  //  RACK 判定丢失的报文段可能已经重传过（重传又丢了），这时要从头找起
+  auto it = rack_lost_ > 0
+              ? outstanding_bytes_.begin()
+              : lower_bound( outstanding_bytes_.begin(),
+                             outstanding_bytes_.end(),
+                             next_retransmit_,
+                             []( const OutstandingSegment& seg, uint64_t seqno ) { return seg.seqno < seqno; } );
+  for ( ; it != outstanding_bytes_.end(); ++it ) {
+    const uint64_t len = it->length;
+    if ( it->sacked || ( it->seqno < next_retransmit_ && !it->lost ) )
+      continue;
+    //  恢复中第一个未确认的报文段一定丢了（三个重复 ACK、部分确认或者超时），立即重传；
+    //  其余的只有被 RACK 判定丢失、或者在快速恢复中更高的数据已经被 SACK 时才算丢失，并且受 PRR 的发送额度限制
+    if ( it != outstanding_bytes_.begin() || !( recovery_ || rto_recovery_ ) ) {
+      const bool lost = it->lost || ( recovery_ && it->end() <= highest_sacked_ );
+      if ( !lost && rack_lost_ > 0 )
+        continue;
+      if ( !lost || ( recovery_ && congestion_ && recovery_->sndcnt < len ) )
+        break;
+    }
+
+    //  探测报文段不再原样重传
+    if ( probe_ && it->seqno == probe_->seqno ) {
+      it = prev( resend_probe( transmit ) );
+      ++stats_.fast_retransmits;
+      continue;
+    }
 
-    //  如果通过了上述检查，到达下面这一步，则说明buffered_msg 已经 可以确认了
-    is_acknowledged = true; // 表示有字节被确认
-    num_bytes_in_flight_ -= buffered_msg.sequence_length() - syn_flag_;
-    acked_seqno_ += buffered_msg.sequence_length() - syn_flag_;
-    // 最后检查 syn 是否被确认
-    syn_flag_ = sent_syn_ ? syn_flag_ : excepting_seqno <= next_seqno_;
-    outstanding_bytes_.pop();
+    stamp_transmission( *it );
+    transmit_segment( *it, transmit );
+    it->retransmitted = true;
+    rack_lost_ -= it->lost;
+    it->lost = false;
+    next_retransmit_ = max( next_retransmit_, it->end() );
+    ++stats_.fast_retransmits;
+    if ( pacer_ )
+      pacer_->on_send( len );
+    if ( recovery_ ) {
+      recovery_->prr_out += len;
+      recovery_->sndcnt -= min( recovery_->sndcnt, len );
+    }
+  }
+}
+
+void TCPSender::rack_on_delivered( const OutstandingSegment& seg, const TCPReceiverMessage& msg )
+{
+  //  重传过的报文段：回显的时间戳早于重传，或者重传之后还不到一个最小 RTT 就到了，
+  //  说明到达的是之前的那次发送，不能用来推进 RACK
+  if ( seg.retransmitted ) {
+    if ( timestamps_ && msg.timestamp_echo.has_value()
+         && static_cast<int32_t>( *msg.timestamp_echo - static_cast<uint32_t>( seg.sent_ms ) ) < 0 )
+      return;
+    if ( now_ms_ - seg.sent_ms < rtt_->min_RTT_ms() )
+      return;
+  }
+
+  RackState& rack = rack_state_;
+  //  序号更低、没有重传过的报文段比更高的数据晚到：网络有乱序
+  if ( !seg.retransmitted && seg.end() < rack.fack )
+    rack.reordering_seen = true;
+  rack.fack = max( rack.fack, seg.end() );
+
+  if ( seg.sent_ms > rack.xmit_ms || ( seg.sent_ms == rack.xmit_ms && seg.end() > rack.end_seq ) ) {
+    rack.xmit_ms = seg.sent_ms;
+    rack.end_seq = seg.end();
+    rack.rtt_ms = now_ms_ - seg.sent_ms;
+  }
+}
+
+uint64_t TCPSender::rack_reordering_window() const
+{
+  if ( !rack_state_.reordering_seen
+       && ( recovery_ || rto_recovery_ || sacked_bytes_ >= DUP_ACK_THRESHOLD * MSS_ ) )
+    return 0;
+  //  RFC 8985 的默认值：最小 RTT 的四分之一，但不超过 SRTT。按毫秒向上取整、至少一个 tick，
+  //  否则在 RTT 不到 4 ms 的路径上，只乱序一个报文段也会被立即判定为丢失
+  return max<uint64_t>( min( ( rtt_->min_RTT_ms() + 3 ) / 4, rtt_->smoothed_RTT_ms() ), 1 );
+}
+
+bool TCPSender::rack_detect_loss()
+{
+  rack_deadline_ms_.reset();
+  const RackState& rack = rack_state_;
+  if ( rack.end_seq == 0 )
+    return false;
+
+  const uint64_t reordering_window = rack_reordering_window();
+  uint64_t timeout = 0;
+  bool marked = false;
+  //  序号不低于 rack.end_seq 的报文段（除了少数重传过的）都是在它之后发送的，不必再看
+  for ( auto it = outstanding_bytes_.begin(); it != outstanding_bytes_.end() && it->seqno < rack.end_seq; ++it ) {
+    if ( it->sacked || it->lost )
+      continue;
+    const bool sent_before
+      = it->sent_ms < rack.xmit_ms || ( it->sent_ms == rack.xmit_ms && it->end() < rack.end_seq );
+    if ( !sent_before )
+      continue;
+    const uint64_t deadline = it->sent_ms + rack.rtt_ms + reordering_window;
+    if ( deadline > now_ms_ ) {
+      timeout = max( timeout, deadline - now_ms_ );
+      continue;
+    }
+    //  探测报文段丢了只说明路径 MTU 比它小，下一次 push 把它拆开重发，不进入恢复
+    if ( probe_ && it->seqno == probe_->seqno ) {
+      probe_lost_ = true;
+      continue;
+    }
+    it->lost = true;
+    ++rack_lost_;
+    ++stats_.rack_losses;
+    marked = true;
+  }
+  if ( timeout > 0 )
+    rack_deadline_ms_ = now_ms_ + timeout;
+  return marked;
+}
+
+void TCPSender::on_rack_loss( uint64_t delivered_bytes )
+{
+  //  已经在恢复中，或者这个窗口已经降过窗：只需要重传新判定丢失的报文段
+  if ( recovery_ || rto_recovery_ || acked_seqno_ < recover_ )
+    return;
+  enter_recovery( delivered_bytes );
+}
+
+void TCPSender::schedule_loss_probe()
+{
+  tlp_deadline_ms_.reset();
+  //  恢复中、零窗口、一个探测还没有结果或者路径 MTU 探测在途（它有自己的超时处理）时不探测；
+  //  没有 RTT 样本时也不探测，交给 RTO
+  if ( !rack_ || outstanding_bytes_.empty() || recovery_ || rto_recovery_ || tlp_ || probe_ || wnd_size_ == 0
+       || !rtt_->has_sample() )
+    return;
+
+  //  PTO = 2 SRTT；只有一个报文段在途时，对端可能正在延迟 ACK，再多等一个延迟 ACK 的时间
+  uint64_t pto = max( 2 * rtt_->smoothed_RTT_ms(), TLP_MIN_PTO_MS );
+  if ( num_bytes_in_flight_ <= MSS_ )
+    pto += TLP_DELAYED_ACK_MS;
+  //  RTO 来得更早就不必探测了
+  if ( pto < timer_.time_left() )
+    tlp_deadline_ms_ = now_ms_ + pto;
+}
+
+void TCPSender::send_loss_probe( const TransmitFunction& transmit )
+{
+  tlp_deadline_ms_.reset();
+  if ( outstanding_bytes_.empty() )
+    return;
+  tlp_ = TailLossProbe { .end = next_seqno_, .retransmitted = false, .ts = static_cast<uint32_t>( now_ms_ ) };
+  ++stats_.tail_loss_probes;
+
+  //  有还没发送的数据、接收窗口也允许时，在拥塞窗口之外发一个新的报文段（ACK 已经迟了，不再按 Nagle 算法等待）
+  const uint64_t prior_next_seqno = next_seqno_;
+  if ( unsent_bytes() > 0 ) {
+    tlp_budget_ = MSS_;
+    uncork_flush_ = !corked_;
+    push( transmit );
+    tlp_budget_ = 0;
+  }
+
+  //  否则重传最后一个还没被 SACK 的报文段
+  if ( next_seqno_ == prior_next_seqno ) {
+    auto last = find_if( outstanding_bytes_.rbegin(),
+                         outstanding_bytes_.rend(),
+                         []( const OutstandingSegment& seg ) { return !seg.sacked; } );
+    if ( last == outstanding_bytes_.rend() ) {
+      tlp_.reset();
+      return;
+    }
+    stamp_transmission( *last );
+    transmit_segment( *last, transmit );
+    last->retransmitted = true;
+    if ( pacer_ )
+      pacer_->on_send( last->length );
+    tlp_->retransmitted = true;
   }
+  tlp_->end = next_seqno_;
+  //  RTO 从探测发出时重新计时
+  timer_.reset();
+}
 
-  if ( is_acknowledged ) {
-    // 如果全部分组都被确认，那就停止计时器
-    if ( outstanding_bytes_.empty() )
-      timer_ = RetransmissionTimer( initial_RTO_ms_ );
-    else // 否则就只重启计时器
-      timer_ = move( RetransmissionTimer( initial_RTO_ms_ ).active() );
-    retransmission_cnt_ = 0; // 因为要重置 RTO 值，故直接更换新对象
+void TCPSender::stamp_transmission( OutstandingSegment& seg )
+{
+  //  没有数据在途时，发送间隔和确认间隔都从现在算起
+  if ( num_bytes_in_flight_ == 0 )
+    first_sent_ms_ = delivered_ms_ = now_ms_;
+  seg.sent_ms = now_ms_;
+  seg.delivered = delivered_;
+  seg.delivered_ms = delivered_ms_;
+  seg.first_sent_ms = first_sent_ms_;
+  seg.app_limited = app_limited_until_ > 0;
+}
+
+void TCPSender::rate_on_delivered( const OutstandingSegment& seg )
+{
+  delivered_ += seg.length;
+  delivered_ms_ = now_ms_;
+  if ( !rate_from_ || seg.delivered >= rate_from_->delivered ) {
+    rate_from_ = seg;
+    first_sent_ms_ = seg.sent_ms;
   }
 }
 
+void TCPSender::update_rate_sample( optional<uint64_t> rtt_ms, uint64_t newly_delivered )
+{
+  //  受应用限制时在途的数据都到达了，之后发出的报文段又能反映路径的能力
+  if ( app_limited_until_ > 0 && delivered_ > app_limited_until_ )
+    app_limited_until_ = 0;
+  if ( !rate_from_ )
+    return;
+
+  const OutstandingSegment& seg = *rate_from_;
+  rate_sample_ = RateSample { .now_ms = now_ms_,
+                              .delivered = delivered_,
+                              .prior_delivered = seg.delivered,
+                              .newly_delivered = newly_delivered,
+                              .interval_ms = max( seg.sent_ms - seg.first_sent_ms, now_ms_ - seg.delivered_ms ),
+                              .delivery_rate = 0,
+                              .rtt_ms = rtt_ms,
+                              .bytes_in_flight = num_bytes_in_flight_,
+                              .app_limited = seg.app_limited };
+  //  发送间隔和确认间隔取较长的那个，ACK 压缩不会让速率虚高；间隔比最小 RTT 还短的样本仍然不可信
+  const uint64_t min_rtt = rtt_ ? rtt_->min_RTT_ms() : 0;
+  if ( rate_sample_.interval_ms > 0 && rate_sample_.interval_ms >= min_rtt )
+    rate_sample_.delivery_rate = ( delivered_ - seg.delivered ) * 1000 / rate_sample_.interval_ms;
+  rate_from_.reset();
+
+  if ( congestion_ )
+    congestion_->on_rate_sample( rate_sample_ );
+}
+
+uint64_t TCPSender::pipe() const
+{
+  const uint64_t delivered = peer_sacks_ ? sacked_bytes_ : sacked_out_ * MSS_;
+  return num_bytes_in_flight_ - min( num_bytes_in_flight_, delivered );
+}
+
+void TCPSender::update_prr( uint64_t delivered_bytes )
+{
+  if ( !congestion_ )
+    return;
+
+  Recovery& rec = *recovery_;
+  rec.prr_delivered += delivered_bytes;
+  const uint64_t mss = MSS_;
+  const uint64_t ssthresh = congestion_->ssthresh();
+  const uint64_t pipe = TCPSender::pipe();
+
+  uint64_t sndcnt = 0;
+  if ( pipe > ssthresh ) {
+    //  在途数据多于 ssthresh：按接收方收到的比例发送，一个 RTT 后在途数据正好降到 ssthresh
+    const uint64_t target = ( rec.prr_delivered * ssthresh + rec.recover_fs - 1 ) / rec.recover_fs;
+    sndcnt = target - min( target, rec.prr_out );
+  } else {
+    //  在途数据已经少于 ssthresh（连续丢包）：像慢启动那样补回去，但不超过 ssthresh（PRR-SSRB）
+    const uint64_t limit = max( rec.prr_delivered - min( rec.prr_delivered, rec.prr_out ), delivered_bytes ) + mss;
+    sndcnt = min( ssthresh - pipe, limit );
+  }
+  //  按整个报文段发送；没用完的额度会在下一个 ACK 时重新算进来
+  rec.sndcnt = sndcnt / mss * mss;
+}
+
 void TCPSender::tick( uint64_t ms_since_last_tick, const TransmitFunction& transmit )
 {
+  now_ms_ += ms_since_last_tick;
+
   //  如果计时器超时，说明之前发送的数据包没有在规定的时间内得到确认
-  if ( timer_.tick( ms_since_last_tick ).is_expired() ) {
-    transmit( outstanding_bytes_.front() ); 
+  timer_.tick( ms_since_last_tick );
+  if ( timer_.is_expired() && probe_ && outstanding_bytes_.front().seqno == probe_->seqno ) {
+    //  探测报文段超时：同样只说明路径 MTU 比它小，拆开重发，不退避也不降窗
+    resend_probe( transmit );
+    timer_.reset();
+  } else if ( timer_.is_expired() ) {
+    OutstandingSegment& front = outstanding_bytes_.front();
+    stamp_transmission( front );
+    transmit_segment( front, transmit );
+    front.retransmitted = true;
+    rack_lost_ -= front.lost;
+    front.lost = false;
+    //  尾部丢包探测没能避免超时，之后交给超时恢复
+    tlp_deadline_ms_.reset();
+    tlp_.reset();
     //  当接收窗口大小为 0 时，意味着接收方无法再接收任何数据，发送方也不应立即进行下次重传，停止定时器的计时
     if ( wnd_size_ == 0 )
       timer_.reset();
     //  当窗口大小大于 0 时，接收方允许接收数据，发送方开始一个新的超时计时器，其RTO_的值翻倍
-    else
+    //  这次超时也是拥塞的信号（零窗口探测的超时则不是）
+    else {
       timer_.timeout().reset();
+      //  第一次超时时记下降窗之前的状态，之后的 ACK 可能证明这次超时是虚假的；连续超时不再撤销
+      timeout_check_.reset();
+      if ( congestion_ && retransmission_cnt_ == 0 && ( timestamps_ || frto_ ) )
+        timeout_check_ = SpuriousTimeoutCheck { .prior_cwnd = congestion_->cwnd(),
+                                                .prior_ssthresh = congestion_->ssthresh(),
+                                                .retransmit_ts = static_cast<uint32_t>( now_ms_ ) };
+      if ( congestion_ )
+        congestion_->on_rto( num_bytes_in_flight_ );
+      //  超时结束快速恢复；超时之前发出的数据引起的重复 ACK 不再触发快速重传
+      recovery_.reset();
+      dup_acks_ = 0;
+      sacked_out_ = 0;
+      next_retransmit_ = front.end();
+      recover_ = next_seqno_;
+      rto_recovery_ = loss_recovery_;
+      ++stats_.timeouts;
+    }
     //增加重传次数
     ++retransmission_cnt_;
   }
+
+  //  RACK 计时器：之前还没到时间的报文段现在可以判定丢失了
+  if ( rack_deadline_ms_ && now_ms_ >= *rack_deadline_ms_ && rack_detect_loss() ) {
+    on_rack_loss( 0 );
+    push( transmit );
+  }
+
+  //  尾部丢包探测
+  if ( tlp_deadline_ms_ && now_ms_ >= *tlp_deadline_ms_ )
+    send_loss_probe( transmit );
+
+  //  按发送速率补充令牌，继续发送之前因为令牌不够而停下的数据
+  if ( pacer_ ) {
+    pacer_->tick( ms_since_last_tick, pacing_limited_ );
+    if ( pacing_limited_ )
+      push( transmit );
+  }
+
+  //  塞住的小报文段等到了 autocork 超时，不再等了
+  if ( corked_since_ms_ && now_ms_ - *corked_since_ms_ >= autocork_timeout_ms_ )
+    push( transmit );
+}
+
+uint64_t TCPSender::pacing_rate() const
+{
+  if ( !pacer_ )
+    return 0;
+  if ( fixed_pacing_rate_ > 0 )
+    return fixed_pacing_rate_;
+  if ( congestion_ && congestion_->pacing_rate() > 0 )
+    return congestion_->pacing_rate();
+  if ( !rtt_->has_sample() )
+    return 0;
+
+  //  一个窗口的数据在一个 SRTT 里发完；慢启动时 cwnd 每个 RTT 翻倍，速率要给到 200% 才跟得上（和 Linux 一样）
+  const uint64_t window = congestion_ ? congestion_->cwnd() : max<uint64_t>( wnd_size_, 1 );
+  const bool slow_start = congestion_ && congestion_->cwnd() < congestion_->ssthresh();
+  const uint64_t pct = slow_start ? PACING_SLOW_START_PCT : PACING_CA_PCT;
+  return window * pct * 10 / max<uint64_t>( rtt_->smoothed_RTT_ms(), 1 );
 }
 
 TCPSenderMessage TCPSender::make_message( uint64_t seqno, string payload, bool SYN, bool FIN ) const
@@ -176,7 +865,107 @@ TCPSenderMessage TCPSender::make_message( uint64_t seqno, string payload, bool S
            .SYN = SYN,
            .payload = move( payload ),
            .FIN = FIN,
-           .RST = input_.reader().has_error() };
+           .RST = input_.reader().has_error(),
+           .SACK_permitted = SYN && sack_permitted_,
+           .MSS = SYN ? announced_MSS_ : uint16_t {},
+           .window_scale = SYN ? window_shift_ : nullopt,
+           .timestamp = timestamp(),
+           .ECN = SYN && ecn_ };
+}
+
+optional<uint32_t> TCPSender::timestamp() const
+{
+  return timestamps_ ? optional { static_cast<uint32_t>( now_ms_ ) } : nullopt;
+}
+
+void TCPSender::set_peer_ECN( bool peer_ecn )
+{
+  ecn_ = ecn_ && peer_ecn;
+}
+
+void TCPSender::set_peer_timestamps( bool peer_timestamps )
+{
+  //  只看对端的第一个 SYN：重传的 SYN 或重复的 SYN-ACK 不能再让 payload 缩小一次
+  if ( !timestamps_ || timestamps_agreed_ )
+    return;
+  timestamps_ = peer_timestamps;
+  timestamps_agreed_ = true;
+
+  //  之后每个报文段都带着时间戳选项，payload 要相应地变小，整个报文段才不会超过路径 MTU（RFC 6691）
+  if ( timestamps_ ) {
+    probe_ceiling_ -= min<uint64_t>( probe_ceiling_ - 1, TCPConfig::TIMESTAMPS_LEN );
+    set_MSS( MSS_ - min<uint64_t>( MSS_ - 1, TCPConfig::TIMESTAMPS_LEN ) );
+  }
+}
+
+void TCPSender::set_peer_window_scale( optional<uint8_t> peer_shift )
+{
+  if ( window_shift_.has_value() && peer_shift.has_value() )
+    peer_window_shift_ = min( *peer_shift, TCPConfig::MAX_WINDOW_SHIFT );
+}
+
+void TCPSender::set_peer_MSS( uint16_t peer_MSS )
+{
+  const uint64_t limit = peer_MSS > 0 ? peer_MSS : TCPConfig::DEFAULT_PEER_MSS;
+  probe_ceiling_ = min( probe_ceiling_, limit );
+  if ( MSS_ > limit )
+    set_MSS( limit );
+}
+
+void TCPSender::set_MSS( uint64_t limit )
+{
+  MSS_ = limit;
+  if ( next_seqno_ <= 1 )
+    congestion_ = make_congestion_controller( congestion_algorithm_, MSS_ );
+  else if ( congestion_ )
+    congestion_->set_mss( MSS_ );
+  if ( pacer_ )
+    pacer_->set_mss( MSS_ );
+}
+
+uint64_t TCPSender::probe_size() const
+{
+  if ( !mtu_probing_ || probe_ || recovery_ || rto_recovery_ || probe_ceiling_ < MSS_ + MTU_PROBE_MIN_STEP )
+    return 0;
+  return MSS_ + ( probe_ceiling_ - MSS_ + 1 ) / 2;
+}
+
+void TCPSender::on_probe_delivered()
+{
+  set_MSS( probe_->size );
+  probe_.reset();
+}
+
+deque<TCPSender::OutstandingSegment>::iterator TCPSender::resend_probe( const TransmitFunction& transmit )
+{
+  auto it = lower_bound( outstanding_bytes_.begin(),
+                         outstanding_bytes_.end(),
+                         probe_->seqno,
+                         []( const OutstandingSegment& seg, uint64_t seqno ) { return seg.seqno < seqno; } );
+  const OutstandingSegment probe = *it;
+  it = outstanding_bytes_.erase( it );
+  probe_ceiling_ = probe_->size - 1;
+  probe_.reset();
+  ++stats_.mtu_probes_lost;
+
+  //  payload 还在发送缓冲区里，按新的 MSS 重新切分即可。拆开的报文段都算重传过的（Karn 算法），
+  //  最后一个带上原来的 FIN
+  for ( uint64_t offset = 0; offset < probe.payload_size(); offset += MSS_ ) {
+    const uint64_t size = min( MSS_, probe.payload_size() - offset );
+    const bool FIN = probe.FIN && offset + size == probe.payload_size();
+    OutstandingSegment piece { .seqno = probe.seqno + offset,
+                               .length = size + FIN,
+                               .SYN = false,
+                               .FIN = FIN,
+                               .sent_ms = now_ms_,
+                               .retransmitted = true,
+                               .sacked = false };
+    stamp_transmission( piece );
+    transmit_segment( piece, transmit );
+    it = next( outstanding_bytes_.insert( it, piece ) );
+  }
+  next_retransmit_ = max( next_retransmit_, probe.end() );
+  return it;
 }
 
 uint64_t TCPSender::sequence_numbers_in_flight() const
@@ -188,3 +977,13 @@ uint64_t TCPSender::consecutive_retransmissions() const
 {
   return retransmission_cnt_;
 }
+
+uint64_t TCPSender::congestion_window() const
+{
+  return congestion_ ? congestion_->cwnd() : UINT64_MAX;
+}
+
+uint64_t TCPSender::slow_start_threshold() const
+{
+  return congestion_ ? congestion_->ssthresh() : UINT64_MAX;
+}
@@ -1,19 +1,26 @@
 #pragma once
 
 #include "byte_stream.hh"
+#include "congestion_controller.hh"
+#include "pacer.hh"
+#include "tcp_config.hh"
 #include "tcp_receiver_message.hh"
 #include "tcp_sender_message.hh"
 
 #include <cstdint>
+#include <deque>
 #include <functional>
-#include <queue>
+#include <memory>
+#include <optional>
 #include <utility>
 
 // 超时计时器
 class RetransmissionTimer
 {
 public:
-  RetransmissionTimer( uint64_t initial_RTO_ms ) : RTO_( initial_RTO_ms ) {}
+  RetransmissionTimer( uint64_t initial_RTO_ms, uint64_t max_RTO_ms = UINT64_MAX )
+    : RTO_( initial_RTO_ms ), max_RTO_( max_RTO_ms )
+  {}
 
   //  检查定时器是否已经到达超时时间
   bool is_expired() const noexcept { return is_active_ && time_passed_ >= RTO_; }
@@ -24,7 +31,7 @@ public:
   //  激活定时器
   RetransmissionTimer& active() noexcept;
 
-  /*  重传超时时间（RTO_）翻倍（即实现所谓的指数退避机制）。
+  /*  重传超时时间（RTO_）翻倍（即实现所谓的指数退避机制），但不超过 max_RTO_。
       每次定时器超时后，超时时间会加倍，以避免频繁的重传加剧网络拥堵。  */
   RetransmissionTimer& timeout() noexcept;
 
@@ -34,11 +41,20 @@ public:
   //  更新定时器状态: time_passed_ += ms_since_last_tick
   RetransmissionTimer& tick( uint64_t ms_since_last_tick ) noexcept;
 
+  //  当前的重传超时时间
+  uint64_t RTO() const noexcept { return RTO_; }
+
+  //  距离超时还有多久；没有激活时按整个 RTO 计算
+  uint64_t time_left() const noexcept { return time_passed_ >= RTO_ ? 0 : RTO_ - time_passed_; }
+
 private:
   /*  当前的重传超时时间（Retransmission Timeout，单位是毫秒）。
       该变量会被动态调整，初始值通过构造函数传入。  */
   uint64_t RTO_;
 
+  //  指数退避的上限
+  uint64_t max_RTO_;
+
   //记录自定时器激活后流逝的时间（单位是毫秒）。每次 tick() 调用时会增加此值。
   uint64_t time_passed_ {};
 
@@ -46,13 +62,82 @@ private:
   bool is_active_ {};
 };
 
+// 往返时间估计（RFC 6298）：SRTT/RTTVAR 按 Jacobson 的定点方式保存（SRTT 放大 8 倍，RTTVAR 放大 4 倍）
+class RTTEstimator
+{
+public:
+  static constexpr uint64_t CLOCK_GRANULARITY_MS = 1; // tick() 的时间精度 G
+
+  RTTEstimator( uint64_t initial_RTO_ms, uint64_t min_RTO_ms, uint64_t max_RTO_ms );
+
+  //  加入一个 RTT 样本（调用者负责按 Karn 算法排除重传过的报文段），并重新计算 RTO
+  void sample( uint64_t rtt_ms );
+
+  bool has_sample() const noexcept { return has_sample_; }
+  uint64_t smoothed_RTT_ms() const noexcept { return srtt_x8_ >> 3; }
+  uint64_t RTT_variation_ms() const noexcept { return rttvar_x4_ >> 2; }
+  uint64_t RTO_ms() const noexcept { return RTO_; }
+
+  //  见过的最小 RTT（RACK 用它估计乱序窗口）；没有样本时为 UINT64_MAX
+  uint64_t min_RTT_ms() const noexcept { return min_rtt_; }
+
+private:
+  uint64_t min_RTO_;
+  uint64_t max_RTO_;
+  uint64_t RTO_;
+  uint64_t srtt_x8_ {};
+  uint64_t rttvar_x4_ {};
+  uint64_t min_rtt_ { UINT64_MAX };
+  bool has_sample_ {};
+};
+
 class TCPSender
 {
 public:
+  static constexpr uint64_t DUP_ACK_THRESHOLD = 3;      // 收到这么多个重复 ACK 就快速重传
+  static constexpr uint64_t PACING_SLOW_START_PCT = 200; // 慢启动时发送速率是 cwnd/SRTT 的百分之多少
+  static constexpr uint64_t PACING_CA_PCT = 120;         // 拥塞避免时发送速率是 cwnd/SRTT 的百分之多少
+  static constexpr uint64_t MTU_PROBE_MIN_STEP = 32;     // 可能的 MSS 范围小于这么多字节时停止路径 MTU 探测
+  static constexpr uint64_t TLP_MIN_PTO_MS = 10;         // 尾部丢包探测至少等这么久
+  static constexpr uint64_t TLP_DELAYED_ACK_MS = 200;    // 只有一个报文段在途时，为对端的延迟 ACK 多等这么久
+
+  //  发送方的统计信息（用于监控）
+  struct Stats
+  {
+    uint64_t fast_retransmits {};  // 重复 ACK 或部分确认触发的重传
+    uint64_t timeouts {};          // 计时器超时触发的重传
+    uint64_t spurious_timeouts {}; // 被 Eifel 或 F-RTO 判断为虚假、撤销了降窗的超时
+    uint64_t rack_losses {};       // RACK 按发送时间判定丢失的报文段
+    uint64_t tail_loss_probes {};  // 超时之前发出的尾部丢包探测
+    uint64_t ecn_reductions {};    // 因为 ECE 而降窗的次数
+    uint64_t mtu_probes {};        // 发出的路径 MTU 探测报文段
+    uint64_t mtu_probes_lost {};   // 丢失的探测报文段（路径 MTU 比它小）
+  };
+
+  //  经典的发送方：只受接收方窗口限制，RTO 固定从 initial_RTO_ms 开始
   TCPSender( ByteStream&& input, Wrap32 isn, uint64_t initial_RTO_ms )
     : input_( std::move( input ) ), isn_( isn ), initial_RTO_ms_( initial_RTO_ms ), timer_( initial_RTO_ms )
   {}
 
+  //  按 TCPConfig 构造：初始序号、拥塞控制算法取自配置，RTO 按测得的 RTT 自适应（限制在配置的上下限之间）
+  TCPSender( ByteStream&& input, const TCPConfig& cfg );
+
+  //  对端在 SYN 里宣告的 MSS（0 表示没有 MSS 选项，按 DEFAULT_PEER_MSS 处理），发出的报文段不会超过它
+  void set_peer_MSS( uint16_t peer_MSS );
+
+  //  对端 SYN 里的窗口缩放选项：两端都带了这个选项时，之后收到的窗口要左移这么多位（RFC 7323）
+  void set_peer_window_scale( std::optional<uint8_t> peer_shift );
+
+  //  对端 SYN 里有没有时间戳选项：两端都带了，之后每个报文段都打上时间戳（RFC 7323），否则不再打
+  void set_peer_timestamps( bool peer_timestamps );
+
+  //  对端 SYN 里有没有请求 ECN：两端都请求了，之后的数据报文段标记为 ECN-capable，并且对 ECE 降窗（RFC 3168）
+  void set_peer_ECN( bool peer_ecn );
+
+  //  塞住（cork）期间只发送满 MSS 的报文段，剩下不足一个 MSS 的数据等解除、凑满或者 autocork 超时再发
+  void set_corked( bool corked );
+  bool corked() const { return corked_; }
+
   //  生成一个空的 TCP 发送器消息
   TCPSenderMessage make_empty_message() const;
 
@@ -80,6 +165,31 @@ public:
       用于判断是否需要终止连接，或是否应触发指数退避  */
   uint64_t consecutive_retransmissions() const; // How many consecutive *re*transmissions have happened?
 
+  //  拥塞控制状态（用于监控）；没有拥塞控制时 cwnd 为 UINT64_MAX
+  uint64_t congestion_window() const;
+  uint64_t slow_start_threshold() const;
+  const CongestionController* congestion_controller() const { return congestion_.get(); }
+
+  //  当前的 MSS：一个报文段最多携带的字节数（探测报文段除外）
+  uint64_t MSS() const { return MSS_; }
+
+  //  当前的发送速率（字节/秒）；不限速时为 0
+  uint64_t pacing_rate() const;
+
+  //  是否处于快速恢复中
+  bool in_recovery() const { return recovery_.has_value(); }
+
+  //  最近一个交付速率样本（用于监控）
+  const RateSample& rate_sample() const { return rate_sample_; }
+
+  const Stats& stats() const { return stats_; }
+
+  //  RTT 估计（用于监控）；经典的发送方没有估计器，返回 nullptr
+  const RTTEstimator* rtt_estimator() const { return rtt_ ? &*rtt_ : nullptr; }
+
+  //  当前使用的重传超时时间（包含指数退避）
+  uint64_t current_RTO_ms() const { return timer_.RTO(); }
+
   Writer& writer() { return input_.writer(); }
   const Writer& writer() const { return input_.writer(); }
   const Reader& reader() const { return input_.reader(); }
@@ -88,7 +198,155 @@ private:
   //  创建一个 TCPSenderMessage
   TCPSenderMessage make_message( uint64_t seqno, std::string payload, bool SYN, bool FIN = false ) const;
 
+  //  发送缓冲区里还没有发送过的字节数
+  uint64_t unsent_bytes() const;
+
+  //  是否暂缓发送一个带着全部剩余数据、又不足一个 MSS 的小报文段（cork 或者 Nagle 算法）
+  bool hold_small_segment();
+
+  //  本次 push 最多可以让多少序号在途
+  uint64_t send_window() const;
+
+  //  处理重复 ACK：有限发送、进入快速恢复或者在恢复中推进 PRR；delivered_bytes 是接收方新收到的序号数
+  void on_duplicate_ack( uint64_t delivered_bytes );
+
+  //  进入快速恢复：降窗，并从第一个未确认的报文段开始重传
+  void enter_recovery( uint64_t delivered_bytes );
+
+  //  在快速恢复中处理确认了新数据的 ACK（部分确认或者结束恢复）
+  void on_recovery_ack( uint64_t delivered_bytes, uint64_t ackno );
+
+  //  按 SACK 块标记记分板上已经到达接收方的报文段，返回新标记的序号数
+  uint64_t update_scoreboard( const TCPReceiverMessage& msg );
+
+  //  重传丢失的报文段：第一个未确认的报文段，快速恢复中被 SACK 的数据之下的空洞，以及 RACK 判定丢失的报文段
+  void retransmit_lost( const TransmitFunction& transmit );
+
+  //  RACK：比最近到达的报文段早发送、又过了 RTT 加乱序窗口还没到达的报文段判定为丢失；
+  //  还没到时间的，按最晚的那个设置 RACK 计时器。返回是否判定了新的丢失
+  bool rack_detect_loss();
+
+  //  RACK 的乱序窗口：没见过乱序时，恢复中或者已经 SACK 了足够多的数据就不再等待
+  uint64_t rack_reordering_window() const;
+
+  //  RACK 判定了丢失：还没在恢复中、也没有对这个窗口降过窗时进入快速恢复
+  void on_rack_loss( uint64_t delivered_bytes );
+
+  //  尾部丢包探测（TLP）：有数据在途、不在恢复中时，在 RTO 之前约 2 SRTT 的时候发一个探测
+  void schedule_loss_probe();
+
+  //  PTO 到了：有新数据就发一个新的报文段，否则重传最后一个报文段，引出一个 ACK（或 SACK）让 RACK 判断丢失
+  void send_loss_probe( const TransmitFunction& transmit );
+
+  //  估计的在途序号数（RFC 6675 的 pipe）：发出去的减去已经到达接收方的
+  uint64_t pipe() const;
+
+  //  PRR（RFC 6937）：按这次 ACK 交付的字节数计算恢复期间还能发送多少
+  void update_prr( uint64_t delivered_bytes );
+
+  //  把 MSS 改成 limit（对端的 MSS 更小时降低，MTU 探测成功时升高）；
+  //  握手时还没有发送过数据，按新的 MSS 重新计算初始窗口
+  void set_MSS( uint64_t limit );
+
+  //  发出的报文段要打的时间戳（本端的时钟）；不使用时间戳时为空
+  std::optional<uint32_t> timestamp() const;
+
+  //  超时之后第一次确认了新数据：用 Eifel 或 F-RTO 判断这次超时是不是虚假的
+  void check_spurious_timeout( const TCPReceiverMessage& msg, uint64_t ackno );
+
+  //  下一个路径 MTU 探测报文段的长度（二分查找）；不需要再探测时为 0
+  uint64_t probe_size() const;
+
+  //  探测报文段到达了接收方：路径能通过这么大的报文段
+  void on_probe_delivered();
+
+  //  快速恢复的状态（RFC 6582 的 NewReno 加上 RFC 6937 的 PRR）
+  struct Recovery
+  {
+    uint64_t recover_fs;            // 进入恢复时在途的序号数
+    uint64_t prr_delivered {};      // 恢复开始以来接收方收到的序号数
+    uint64_t prr_out {};            // 恢复开始以来发送的序号数（包括重传）
+    uint64_t sndcnt { UINT64_MAX }; // 现在还可以发送的序号数；没有拥塞控制时不受限
+  };
+
+  //  超时之后、判断出这次超时是真是假之前的状态
+  struct SpuriousTimeoutCheck
+  {
+    uint64_t prior_cwnd;         // 超时之前的拥塞窗口，虚假超时要恢复它
+    uint64_t prior_ssthresh;     // 超时之前的慢启动阈值
+    uint32_t retransmit_ts;      // 超时重传时打的时间戳（Eifel）
+    bool new_data_sent {};       // F-RTO：第一个 ACK 之后已经改为发送新数据，等下一个 ACK 判断
+    uint64_t new_data_budget {}; // F-RTO：拥塞窗口之外还可以发送的新数据
+  };
+
+  //  一个已经发送、尚未被确认的报文段。它只记录序号范围：payload 留在发送缓冲区 input_ 里，
+  //  直到整个报文段被确认才弹出，（重新）发送时再从缓冲区里取出
+  struct OutstandingSegment
+  {
+    uint64_t seqno;     // 报文段第一个序号的绝对值
+    uint64_t length;    // 占用的序号数（包括 SYN 和 FIN）
+    bool SYN;
+    bool FIN;
+    uint64_t sent_ms;   // 最近一次发送的时间（RACK 按它判断丢失；重传过的不用来采样 RTT）
+    bool retransmitted; // 重传过的报文段不能用来采样 RTT（Karn 算法）
+    bool sacked;        // 接收方已经用 SACK 报告收到了，不需要重传
+    bool lost {};       // RACK 判定丢失、等待重传
+
+    //  最近一次发送时连接的交付状态（交付速率估计）
+    uint64_t delivered {};     // 当时已经到达接收方的序号数
+    uint64_t delivered_ms {};  // 当时最近一次有数据到达接收方的时间
+    uint64_t first_sent_ms {}; // 当时最近到达的报文段的发送时间，发送间隔从它算起
+    bool app_limited {};       // 当时发送方是否受应用限制
+
+    uint64_t end() const { return seqno + length; }
+    uint64_t payload_size() const { return length - SYN - FIN; }
+  };
+
+  //  RACK 的状态：已经到达接收方的报文段里最近发送的那个
+  struct RackState
+  {
+    uint64_t xmit_ms {};     // 它最近一次发送的时间
+    uint64_t end_seq {};     // 它的结束序号；为 0 时还没有报文段到达
+    uint64_t rtt_ms {};      // 它的 RTT
+    uint64_t fack {};        // 到达接收方的最高结束序号
+    bool reordering_seen {}; // 是否见过乱序：序号更低、又没重传过的报文段在 fack 之后才到
+  };
+
+  //  一个在途的尾部丢包探测
+  struct TailLossProbe
+  {
+    uint64_t end;       // 探测发出时已经发送的最高序号，确认越过它说明探测有了结果
+    bool retransmitted; // 探测是重传的最后一个报文段（而不是新数据）
+    uint32_t ts;        // 探测时打的时间戳
+  };
+
+  //  一个在途的路径 MTU 探测报文段
+  struct MTUProbe
+  {
+    uint64_t seqno; // 报文段第一个序号的绝对值
+    uint64_t size;  // payload 长度
+  };
+
+  //  探测报文段丢了：路径 MTU 比它小。把它拆成 MSS_ 大小的报文段重新发送，返回这些报文段之后的位置
+  std::deque<OutstandingSegment>::iterator resend_probe( const TransmitFunction& transmit );
+
+  //  按报文段的序号范围从发送缓冲区取出 payload，组装成消息发送出去；CWR 告诉接收方已经对 ECE 降过窗了
+  void transmit_segment( const OutstandingSegment& seg, const TransmitFunction& transmit, bool CWR = false ) const;
+
+  //  RACK（RFC 8985）：一个报文段到达了接收方（被累计确认或者 SACK），记下最近发送的那个
+  void rack_on_delivered( const OutstandingSegment& seg, const TCPReceiverMessage& msg );
+
+  //  （重新）发送一个报文段之前：记下发送时间，以及交付速率估计需要的连接状态
+  void stamp_transmission( OutstandingSegment& seg );
+
+  //  交付速率估计：一个报文段到达了接收方，累计 delivered_，并记下这次到达的报文段里最近发送的那个
+  void rate_on_delivered( const OutstandingSegment& seg );
+
+  //  一个 ACK 处理完之后，用最近发送的那个到达的报文段生成速率样本，交给拥塞控制算法
+  void update_rate_sample( std::optional<uint64_t> rtt_ms, uint64_t newly_delivered );
+
   //  发送方的数据源，TCPSender 会从这个字节流中读取数据
+  //  已经发送、尚未确认的字节也留在里面（发送缓冲区），确认之后才弹出
   ByteStream input_;
 
   //  在 TCP 连接中，发送方的序列号从一个随机的初始值 isn_ 开始。
@@ -97,15 +355,61 @@ private:
   //  初始的重传超时时间
   uint64_t initial_RTO_ms_;
 
-  uint16_t wnd_size_ { 1 }; // 初始假定窗口大小为 1
+  //  指数退避的上限
+  uint64_t max_RTO_ms_ { UINT64_MAX };
+
+  //  一个报文段最多携带的字节数，以及在 SYN 里向对端宣告的 MSS（0 表示不宣告）
+  uint64_t MSS_ { TCPConfig::MAX_PAYLOAD_SIZE };
+  uint16_t announced_MSS_ {};
+
+  //  路径 MTU 探测（RFC 4821）：在 (MSS_, probe_ceiling_] 里二分查找路径能通过的最大报文段
+  bool mtu_probing_ {};
+  uint64_t probe_ceiling_ { TCPConfig::MAX_PAYLOAD_SIZE };
+  std::optional<MTUProbe> probe_ {};
+
+  //  重复 ACK 表明探测报文段丢了，下一次 push 要把它拆开重发
+  bool probe_lost_ {};
+
+  //  RTT 估计器；为空时每次确认都把 RTO 恢复为 initial_RTO_ms_
+  std::optional<RTTEstimator> rtt_ {};
+
+  //  发送调度器；为空时每次 push 把窗口允许的数据一次发完
+  std::optional<Pacer> pacer_ {};
+
+  //  固定的发送速率（字节/秒）；为 0 时按 cwnd/SRTT 计算
+  uint64_t fixed_pacing_rate_ {};
+
+  //  上一次 push 是否因为令牌不够而停止，需要在 tick() 里继续发送
+  bool pacing_limited_ {};
+
+  //  Nagle 算法（RFC 896）：有数据在途时，不足一个 MSS 的数据等 ACK 回来再发，攒成更大的报文段
+  bool nagle_ {};
+
+  //  是否塞住，塞住时小报文段最多等待多久，以及小报文段从什么时候开始被塞住
+  bool corked_ {};
+  uint64_t autocork_timeout_ms_ { TCPConfig::AUTOCORK_DFLT };
+  std::optional<uint64_t> corked_since_ms_ {};
+
+  //  刚解除塞住：下一次 push 把剩下的小报文段立即发出去，不受 Nagle 算法限制
+  bool uncork_flush_ {};
+
+  uint64_t wnd_size_ { 1 }; // 初始假定窗口大小为 1
+
+  //  在 SYN 里宣告的本端接收窗口缩放位数（为空时不宣告），以及对端窗口的缩放位数
+  std::optional<uint8_t> window_shift_ {};
+  uint8_t peer_window_shift_ {};
   uint64_t next_seqno_ {};  // 待发送的下一个字节序号
   uint64_t acked_seqno_ {}; // 已确认的字节序号
 
-  //  标记 是否需要在接下来的 TCP 报文中发送 SYN 标志
-  bool syn_flag_ {};
+  //  是否给报文段打时间戳：本端启用时 SYN 带上，对端的 SYN 没有带就不再打
+  bool timestamps_ {};
+  bool timestamps_agreed_ {}; // 已经按对端的 SYN 确定了是否打时间戳
+
+  //  没有时间戳时是否用 F-RTO 判断虚假超时
+  bool frto_ {};
 
-  //  标记 是否需要在接下来的 TCP 报文中发送 FIN 标志
-  bool fin_flag_ {};
+  //  超时之后等待判断这次超时是不是虚假的时有值
+  std::optional<SpuriousTimeoutCheck> timeout_check_ {};
 
   //  标记 是否已经发送过 SYN 标志
   bool sent_syn_ {}; 
@@ -119,9 +423,83 @@ private:
   //  存储连续重传的次数。用于判断是否需要增加重传间隔时间
   uint64_t retransmission_cnt_ {};
 
-  //  存储尚未被确认的数据段（即已经发送但未收到 ACK 的消息）
-  std::queue<TCPSenderMessage> outstanding_bytes_ {};
+  //  存储尚未被确认的数据段（即已经发送但未收到 ACK 的报文段的序号范围）
+  //  按序号排列，同时也是 SACK 的记分板
+  std::deque<OutstandingSegment> outstanding_bytes_ {};
 
   //  记录当前发送出去但尚未被接收方确认的字节数。这些字节仍然“在飞行中”
   uint64_t num_bytes_in_flight_ {};
+
+  //  拥塞控制算法；为空时只受接收方窗口限制
+  std::unique_ptr<CongestionController> congestion_ {};
+  TCPConfig::CongestionControl congestion_algorithm_ { TCPConfig::CongestionControl::None };
+
+  //  上一次 push 是否因为没有数据可发（而不是窗口已满）而停止
+  bool app_limited_ {};
+
+  //  由 tick() 累计的当前时间
+  uint64_t now_ms_ {};
+
+  //  是否启用快速重传和快速恢复（经典的发送方只在超时后重传）
+  bool loss_recovery_ {};
+
+  //  连续收到的重复 ACK 个数
+  uint64_t dup_acks_ {};
+
+  //  是否在 SYN 中允许对端发送 SACK，以及对端是否真的发来过 SACK 块
+  bool sack_permitted_ {};
+  bool peer_sacks_ {};
+
+  //  记分板上被 SACK 的序号数，以及被 SACK 的最高序号（之下没被 SACK 的报文段在恢复中视为丢失）
+  uint64_t sacked_bytes_ {};
+  uint64_t highest_sacked_ {};
+
+  //  没有 SACK 时按重复 ACK 估计的、已经越过空洞到达接收方的报文段数
+  uint64_t sacked_out_ {};
+
+  //  NewReno 的 recover：进入恢复（或超时）时已经发送的最高序号，确认越过它才算恢复结束
+  uint64_t recover_ {};
+
+  //  正在快速恢复时有值
+  std::optional<Recovery> recovery_ {};
+
+  //  超时之后、确认越过 recover_ 之前：每个部分确认都重传下一个空洞
+  bool rto_recovery_ {};
+
+  //  这一次恢复中还没有重传过的最低序号；起点低于它的报文段已经重传过了
+  uint64_t next_retransmit_ {};
+
+  //  是否启用 RACK-TLP（RFC 8985）
+  bool rack_ {};
+  RackState rack_state_ {};
+
+  //  被 RACK 判定丢失、还没有重传的报文段个数，以及 RACK 计时器到期的时间
+  uint64_t rack_lost_ {};
+  std::optional<uint64_t> rack_deadline_ms_ {};
+
+  //  尾部丢包探测的到期时间，在途的探测，以及探测允许在拥塞窗口之外发送的新数据
+  std::optional<uint64_t> tlp_deadline_ms_ {};
+  std::optional<TailLossProbe> tlp_ {};
+  uint64_t tlp_budget_ {};
+
+  //  交付速率估计（draft-cheng-iccrg-delivery-rate-estimation）：到达接收方的序号数、最近一次有数据到达的时间，
+  //  以及最近到达的报文段的发送时间
+  uint64_t delivered_ {};
+  uint64_t delivered_ms_ {};
+  uint64_t first_sent_ms_ {};
+
+  //  受应用限制时为非 0：delivered_ 越过它（当时在途的数据都到达了）之前，速率样本都标记为受应用限制
+  uint64_t app_limited_until_ {};
+
+  //  这个 ACK 到达的报文段里最近发送的那个，以及最近一个速率样本
+  std::optional<OutstandingSegment> rate_from_ {};
+  RateSample rate_sample_ {};
+
+  //  是否使用 ECN（RFC 3168）；对 ECE 降窗时已经发送的最高序号，确认越过它之前不再因为 ECE 降窗；
+  //  降窗之后的第一个新报文段要带上 CWR
+  bool ecn_ {};
+  uint64_t ecn_recover_ {};
+  bool send_cwr_ {};
+
+  Stats stats_ {};
 };
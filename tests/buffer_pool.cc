@@ -0,0 +1,140 @@
+#include "buffer_pool.hh"
+#include "test_should_be.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+// a string that owns `capacity` bytes of storage, as a producer outside the pool would make it
+string allocated( size_t capacity )
+{
+  string ret;
+  ret.reserve( capacity );
+  return ret;
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    {
+      // each request is served from the smallest class that fits it
+      BufferPool pool;
+      for ( const size_t size : { size_t { 1 }, BufferPool::SMALL_CLASS } ) {
+        string buffer = pool.acquire( size );
+        test_should_be( buffer.empty(), true );
+        test_should_be( buffer.capacity() >= BufferPool::SMALL_CLASS, true );
+        pool.release( move( buffer ) );
+      }
+      test_should_be( pool.stats().misses, uint64_t { 1 } );
+      test_should_be( pool.stats().hits, uint64_t { 1 } );
+      test_should_be( pool.stats().recycled, uint64_t { 2 } );
+
+      // one byte more than the small class comes from the large class, which is still empty
+      string buffer = pool.acquire( BufferPool::SMALL_CLASS + 1 );
+      test_should_be( buffer.capacity() >= BufferPool::LARGE_CLASS, true );
+      test_should_be( pool.stats().misses, uint64_t { 2 } );
+      pool.release( move( buffer ) );
+      buffer = pool.acquire( BufferPool::LARGE_CLASS );
+      test_should_be( pool.stats().hits, uint64_t { 2 } );
+      test_should_be( pool.stats().misses, uint64_t { 2 } );
+
+      // past the large class the allocator serves the request
+      buffer = pool.acquire( BufferPool::LARGE_CLASS + 1 );
+      test_should_be( buffer.capacity() >= BufferPool::LARGE_CLASS + 1, true );
+      test_should_be( pool.stats().misses, uint64_t { 3 } );
+    }
+
+    {
+      // a released buffer comes back empty, with its storage intact
+      BufferPool pool;
+      string buffer = pool.acquire( 100 );
+      buffer.assign( 100, 'x' );
+      const char* storage = buffer.data();
+      pool.release( move( buffer ) );
+      string again = pool.acquire( 100 );
+      test_should_be( again.empty(), true );
+      test_should_be( again.data() == storage, true );
+    }
+
+    {
+      // buffers from outside the pool join the largest class they can hold
+      BufferPool pool;
+      pool.release( allocated( BufferPool::LARGE_CLASS ) );
+      pool.release( allocated( 4 * BufferPool::SMALL_CLASS ) );
+      test_should_be( pool.stats().recycled, uint64_t { 2 } );
+      string small = pool.acquire( BufferPool::SMALL_CLASS );
+      string large = pool.acquire( BufferPool::LARGE_CLASS );
+      test_should_be( pool.stats().hits, uint64_t { 2 } );
+      test_should_be( pool.stats().misses, uint64_t { 0 } );
+      test_should_be( large.capacity() >= BufferPool::LARGE_CLASS, true );
+    }
+
+    {
+      // more than four times a class wastes too much memory to keep
+      BufferPool pool;
+      pool.release( allocated( 4 * BufferPool::SMALL_CLASS + 1 ) );
+      pool.release( allocated( 4 * BufferPool::LARGE_CLASS + 1 ) );
+      test_should_be( pool.stats().recycled, uint64_t { 0 } );
+      test_should_be( pool.stats().dropped, uint64_t { 2 } );
+      pool.acquire( BufferPool::SMALL_CLASS );
+      pool.acquire( BufferPool::LARGE_CLASS );
+      test_should_be( pool.stats().hits, uint64_t { 0 } );
+
+      // anything too small for either class is dropped too, but a string that never allocated is not counted
+      pool.release( allocated( BufferPool::SMALL_CLASS - 1 ) );
+      pool.release( string {} );
+      test_should_be( pool.stats().dropped, uint64_t { 3 } );
+    }
+
+    {
+      // each class keeps at most MAX_FREE_PER_CLASS idle buffers
+      BufferPool pool;
+      vector<string> buffers;
+      for ( size_t i = 0; i <= BufferPool::MAX_FREE_PER_CLASS; ++i ) {
+        buffers.push_back( pool.acquire( BufferPool::SMALL_CLASS ) );
+      }
+      test_should_be( pool.stats().misses, uint64_t { BufferPool::MAX_FREE_PER_CLASS + 1 } );
+      for ( auto& buffer : buffers ) {
+        pool.release( move( buffer ) );
+      }
+      test_should_be( pool.stats().recycled, uint64_t { BufferPool::MAX_FREE_PER_CLASS } );
+      test_should_be( pool.stats().dropped, uint64_t { 1 } );
+
+      // the other class is bounded separately
+      pool.release( allocated( BufferPool::LARGE_CLASS ) );
+      test_should_be( pool.stats().recycled, uint64_t { BufferPool::MAX_FREE_PER_CLASS + 1 } );
+
+      for ( size_t i = 0; i < BufferPool::MAX_FREE_PER_CLASS; ++i ) {
+        buffers[i] = pool.acquire( BufferPool::SMALL_CLASS );
+      }
+      test_should_be( pool.stats().hits, uint64_t { BufferPool::MAX_FREE_PER_CLASS } );
+      pool.acquire( BufferPool::SMALL_CLASS );
+      test_should_be( pool.stats().misses, uint64_t { BufferPool::MAX_FREE_PER_CLASS + 2 } );
+    }
+
+    {
+      // local() is the same pool on every call from a thread
+      BufferPool& pool = BufferPool::local();
+      test_should_be( &pool == &BufferPool::local(), true );
+      const uint64_t hits = pool.stats().hits;
+      pool.release( pool.acquire( BufferPool::SMALL_CLASS ) );
+      pool.acquire( BufferPool::SMALL_CLASS );
+      test_should_be( pool.stats().hits, hits + 1 );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,265 @@
+#include "byte_stream.hh"
+#include "concurrent_byte_stream.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+// Count every heap allocation made by the benchmark loop
+namespace {
+atomic<uint64_t> allocation_count {};
+} // namespace
+
+void* operator new( size_t size )
+{
+  allocation_count.fetch_add( 1, memory_order_relaxed );
+  if ( void* ptr = malloc( size ? size : 1 ) ) { // NOLINT(*-no-malloc, *-owning-memory)
+    return ptr;
+  }
+  throw bad_alloc {};
+}
+
+void operator delete( void* ptr ) noexcept
+{
+  free( ptr ); // NOLINT(*-no-malloc, *-owning-memory)
+}
+
+void operator delete( void* ptr, size_t /* size */ ) noexcept
+{
+  free( ptr ); // NOLINT(*-no-malloc, *-owning-memory)
+}
+
+namespace {
+
+struct Config
+{
+  string backend;
+  uint64_t capacity;
+  size_t write_size;
+  size_t read_size;
+  size_t volume;
+};
+
+struct Result
+{
+  double gigabits_per_second;
+  double ns_per_op;
+  double allocations_per_op;
+};
+
+const string& random_data( size_t volume )
+{
+  static string data;
+  if ( data.size() < volume ) {
+    default_random_engine rd { 789 };
+    uniform_int_distribution<char> ud;
+    data.resize( volume );
+    generate( data.begin(), data.end(), [&] { return ud( rd ); } );
+  }
+  return data;
+}
+
+// Every backend is fed the same way, copying the source view straight into the space the stream reserves,
+// so that allocs/op measures the stream itself and compares across backends
+template<class WriterT>
+void write( WriterT& writer, string_view data )
+{
+  const span<char> space = writer.reserve( data.size() );
+  memcpy( space.data(), data.data(), space.size() );
+  writer.commit( space.size() );
+}
+
+// One "op" is one write into the stream. Every byte read back is checked against the source data.
+template<class StreamT>
+Result run( const Config& cfg )
+{
+  const string_view data = string_view { random_data( cfg.volume ) }.substr( 0, cfg.volume );
+  StreamT stream { cfg.capacity };
+  auto& writer = stream.writer();
+  auto& reader = stream.reader();
+
+  size_t offset = 0;
+  uint64_t writes = 0;
+
+  const uint64_t allocations_before = allocation_count.load();
+  const auto start_time = steady_clock::now();
+
+  while ( reader.bytes_popped() < data.size() ) {
+    if ( offset < data.size() ) {
+      const size_t len = min( cfg.write_size, data.size() - offset );
+      if ( len <= writer.available_capacity() ) {
+        write( writer, data.substr( offset, len ) );
+        offset += len;
+        ++writes;
+      }
+    }
+
+    if ( reader.bytes_buffered() ) {
+      const string_view peeked = reader.peek().substr( 0, cfg.read_size );
+      if ( peeked.empty()
+           or memcmp( peeked.data(), data.data() + reader.bytes_popped(), peeked.size() ) != 0 ) {
+        throw runtime_error( "Mismatch between data written and read (" + cfg.backend + ")" );
+      }
+      reader.pop( peeked.size() );
+    }
+  }
+
+  const auto stop_time = steady_clock::now();
+  const uint64_t allocations = allocation_count.load() - allocations_before;
+
+  const double seconds = duration_cast<duration<double>>( stop_time - start_time ).count();
+  return { .gigabits_per_second = 8 * static_cast<double>( data.size() ) / seconds / 1e9,
+           .ns_per_op = seconds * 1e9 / static_cast<double>( writes ),
+           .allocations_per_op = static_cast<double>( allocations ) / static_cast<double>( writes ) };
+}
+
+Result run_config( const Config& cfg )
+{
+  if ( cfg.backend == "ByteStream" ) {
+    return run<ByteStream>( cfg );
+  }
+  if ( cfg.backend == "ConcurrentByteStream" ) {
+    return run<ConcurrentByteStream>( cfg );
+  }
+  throw runtime_error( "unknown backend: " + cfg.backend );
+}
+
+vector<size_t> parse_list( const char* arg )
+{
+  vector<size_t> ret;
+  istringstream in { arg };
+  for ( string item; getline( in, item, ',' ); ) {
+    ret.push_back( stoull( item, nullptr, 0 ) );
+  }
+  if ( ret.empty() ) {
+    throw runtime_error( "empty list" );
+  }
+  return ret;
+}
+
+vector<string> parse_names( const char* arg )
+{
+  vector<string> ret;
+  istringstream in { arg };
+  for ( string item; getline( in, item, ',' ); ) {
+    ret.push_back( item );
+  }
+  return ret;
+}
+
+void show_usage( const char* argv0 )
+{
+  cerr << "Usage: " << argv0 << " [options]\n\n"
+       << "   --json                 Print results as JSON (default: CSV)\n"
+       << "   --backends <a,b,..>    ByteStream, ConcurrentByteStream\n"
+       << "   --capacities <n,..>    Stream capacities in bytes\n"
+       << "   --writes <n,..>        Write sizes in bytes\n"
+       << "   --reads <n,..>         Read sizes in bytes\n"
+       << "   --volumes <n,..>       Total bytes moved per configuration\n";
+}
+
+void print( const Config& cfg, const Result& res, bool json, bool first )
+{
+  if ( json ) {
+    cout << ( first ? "[\n" : ",\n" ) << "  {\"backend\": \"" << cfg.backend << "\", \"capacity\": " << cfg.capacity
+         << ", \"write_size\": " << cfg.write_size << ", \"read_size\": " << cfg.read_size
+         << ", \"volume\": " << cfg.volume << ", \"gbit_per_s\": " << res.gigabits_per_second
+         << ", \"ns_per_op\": " << res.ns_per_op << ", \"allocs_per_op\": " << res.allocations_per_op << "}";
+  } else {
+    if ( first ) {
+      cout << "backend,capacity,write_size,read_size,volume,gbit_per_s,ns_per_op,allocs_per_op\n";
+    }
+    cout << cfg.backend << "," << cfg.capacity << "," << cfg.write_size << "," << cfg.read_size << ","
+         << cfg.volume << "," << res.gigabits_per_second << "," << res.ns_per_op << "," << res.allocations_per_op
+         << "\n";
+  }
+}
+
+void program_body( span<char*> args )
+{
+  bool json = false;
+  vector<string> backends { "ByteStream", "ConcurrentByteStream" };
+  vector<size_t> capacities { 4096, 65536, 1048576 };
+  vector<size_t> write_sizes { 1, 16, 128, 1500, 16384, 65536 };
+  vector<size_t> read_sizes { 1, 1500, 65536 };
+  vector<size_t> volumes { 1 << 20, 1 << 23 };
+
+  for ( size_t i = 1; i < args.size(); ++i ) {
+    const string_view opt = args[i];
+    if ( opt == "--json" ) {
+      json = true;
+      continue;
+    }
+    if ( opt == "-h" or opt == "--help" or i + 1 == args.size() ) {
+      show_usage( args[0] );
+      exit( opt == "-h" or opt == "--help" ? EXIT_SUCCESS : EXIT_FAILURE );
+    }
+    const char* value = args[++i];
+    if ( opt == "--backends" ) {
+      backends = parse_names( value );
+    } else if ( opt == "--capacities" ) {
+      capacities = parse_list( value );
+    } else if ( opt == "--writes" ) {
+      write_sizes = parse_list( value );
+    } else if ( opt == "--reads" ) {
+      read_sizes = parse_list( value );
+    } else if ( opt == "--volumes" ) {
+      volumes = parse_list( value );
+    } else {
+      show_usage( args[0] );
+      exit( EXIT_FAILURE );
+    }
+  }
+
+  cout << fixed << setprecision( 3 );
+  bool first = true;
+  for ( const auto& backend : backends ) {
+    for ( const auto capacity : capacities ) {
+      for ( const auto write_size : write_sizes ) {
+        for ( const auto read_size : read_sizes ) {
+          for ( const auto volume : volumes ) {
+            if ( write_size > capacity ) {
+              continue; // such a write could never be accepted in full
+            }
+            const Config cfg { backend, capacity, write_size, read_size, volume };
+            print( cfg, run_config( cfg ), json, first );
+            first = false;
+          }
+        }
+      }
+    }
+  }
+  if ( json ) {
+    cout << ( first ? "[]\n" : "\n]\n" );
+  }
+}
+
+} // namespace
+
+int main( int argc, char** argv )
+{
+  try {
+    program_body( span( argv, argc ) );
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -97,6 +97,29 @@ int main()
       test.execute( BytesBuffered { 1 } );
     }
 
+    {
+      ByteStreamTestHarness test { "reserve-commit", 4 };
+      test.execute( ReserveCommit { "cat", 3 } );
+      test.execute( BytesPushed { 3 } );
+      test.execute( AvailableCapacity { 1 } );
+      test.execute( Peek { "cat" } );
+      test.execute( ReserveCommit { "dog", 10 } );
+      test.execute( BytesPushed { 4 } );
+      test.execute( AvailableCapacity { 0 } );
+      test.execute( Peek { "catd" } );
+      test.execute( ReserveCommit { "x", 5 } );
+      test.execute( BytesPushed { 4 } );
+      test.execute( Pop { 3 } );
+      test.execute( ReserveCommit { "og", 0 } );
+      test.execute( BytesPushed { 4 } );
+      test.execute( ReserveCommit { "og", 2 } );
+      test.execute( Peek { "dog" } );
+      test.execute( Close {} );
+      test.execute( ReserveCommit { "z", 1 } );
+      test.execute( BytesPushed { 6 } );
+      test.execute( Peek { "dog" } );
+    }
+
   } catch ( const exception& e ) {
     cerr << "Exception: " << e.what() << endl;
     return EXIT_FAILURE;
@@ -0,0 +1,103 @@
+#include "concurrent_byte_stream.hh"
+#include "eventloop.hh"
+#include "exception.hh"
+
+#include <cstddef>
+#include <exception>
+#include <iostream>
+#include <poll.h>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+using namespace std;
+
+namespace {
+// Block until `fd` (an eventfd) is readable
+void wait_for( FileDescriptor& fd )
+{
+  pollfd pfd { fd.fd_num(), POLLIN, 0 };
+  CheckSystemCall( "poll", ::poll( &pfd, 1, -1 ) );
+}
+
+void transfer_test( const size_t input_len, const size_t capacity, const size_t max_write, const size_t random_seed )
+{
+  const string data = [&] {
+    default_random_engine rd { random_seed };
+    uniform_int_distribution<char> ud;
+    string ret;
+    for ( size_t i = 0; i < input_len; ++i ) {
+      ret += ud( rd );
+    }
+    return ret;
+  }();
+
+  ConcurrentByteStream stream { capacity };
+
+  // Producer: push random-sized slices, sleeping on the writer's fd whenever the ring is full.
+  thread producer { [&] {
+    default_random_engine rd { random_seed + 1 };
+    uniform_int_distribution<size_t> write_size { 1, max_write };
+    ConcurrentWriter& writer = stream.writer();
+    size_t offset = 0;
+    while ( offset < data.size() ) {
+      writer.clear_readiness();
+      if ( writer.available_capacity() == 0 ) {
+        wait_for( writer.readiness_fd() );
+        continue;
+      }
+      const string_view slice = string_view { data }.substr( offset, write_size( rd ) );
+      const uint64_t before = writer.bytes_pushed();
+      writer.push( slice );
+      offset += writer.bytes_pushed() - before;
+    }
+    writer.close();
+  } };
+
+  // Consumer: an EventLoop rule on the reader's fd drains the stream.
+  string output;
+  output.reserve( data.size() );
+  EventLoop loop;
+  ConcurrentReader& reader = stream.reader();
+  loop.add_rule(
+    "drain concurrent stream",
+    reader.readiness_fd(),
+    Direction::In,
+    [&] {
+      reader.clear_readiness();
+      while ( reader.bytes_buffered() ) {
+        const string_view view = reader.peek();
+        output += view;
+        reader.pop( view.size() );
+      }
+    },
+    [&] { return not reader.is_finished(); } );
+
+  while ( loop.wait_next_event( -1 ) != EventLoop::Result::Exit ) {}
+  producer.join();
+
+  if ( not reader.is_finished() ) {
+    throw runtime_error( "ConcurrentReader not finished after writer closed" );
+  }
+
+  if ( output != data ) {
+    throw runtime_error( "Mismatch between data written and read (capacity=" + to_string( capacity ) + ")" );
+  }
+}
+} // namespace
+
+int main()
+{
+  try {
+    transfer_test( 100000, 1, 1, 1 );
+    transfer_test( 1000000, 15, 20, 2 );
+    transfer_test( 1000000, 4096, 1500, 3 );
+    transfer_test( 10000000, 65536, 65536, 4 );
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -89,6 +89,8 @@ void speed_test( const size_t input_len,   // NOLINT(bugprone-easily-swappable-p
 void program_body()
 {
   speed_test( 1e7, 32768, 789, 1500, 128 );
+  speed_test( 1e6, 32768, 789, 1, 1500 );
+  speed_test( 1e7, 1048576, 789, 65536, 65536 );
 }
 
 int main()
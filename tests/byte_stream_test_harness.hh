@@ -3,6 +3,7 @@
 #include "byte_stream.hh"
 #include "common.hh"
 
+#include <algorithm>
 #include <concepts>
 #include <optional>
 #include <utility>
@@ -34,6 +35,32 @@ struct Push : public Action<ByteStream>
   void execute( ByteStream& bs ) const override { bs.writer().push( data_ ); }
 };
 
+struct ReserveCommit : public Action<ByteStream>
+{
+  std::string data_;
+  uint64_t reserve_len_;
+
+  // Reserve `reserve_len` bytes, fill the start of the reservation with `data`, and commit that much
+  ReserveCommit( std::string data, uint64_t reserve_len ) : data_( move( data ) ), reserve_len_( reserve_len ) {}
+  std::string description() const override
+  {
+    return "reserve( " + std::to_string( reserve_len_ ) + " ), commit \"" + Printer::prettify( data_ ) + "\"";
+  }
+  void execute( ByteStream& bs ) const override
+  {
+    const auto space = bs.writer().reserve( reserve_len_ );
+    if ( space.size() > reserve_len_ ) {
+      throw ExpectationViolation { "Writer::reserve() returned more space than requested" };
+    }
+    if ( space.size() > bs.writer().available_capacity() ) {
+      throw ExpectationViolation { "Writer::reserve() returned more space than available capacity" };
+    }
+    const size_t len = std::min( space.size(), data_.size() );
+    std::copy_n( data_.begin(), len, space.begin() );
+    bs.writer().commit( len );
+  }
+};
+
 struct Close : public Action<ByteStream>
 {
   std::string description() const override { return "close"; }
@@ -107,6 +134,44 @@ struct PeekOnce : public Peek
   }
 };
 
+struct PeekViews : public Expectation<ByteStream>
+{
+  std::string output_;
+  uint64_t max_len_;
+  size_t max_views_;
+
+  PeekViews( std::string output, uint64_t max_len, size_t max_views )
+    : output_( move( output ) ), max_len_( max_len ), max_views_( max_views )
+  {}
+
+  std::string description() const override
+  {
+    return "peek( views, " + std::to_string( max_len_ ) + ", " + std::to_string( max_views_ ) + " ) gives \""
+           + Printer::prettify( output_ ) + "\"";
+  }
+
+  void execute( ByteStream& bs ) const override
+  {
+    std::vector<std::string_view> views { "stale" };
+    bs.reader().peek( views, max_len_, max_views_ );
+    if ( views.size() > max_views_ ) {
+      throw ExpectationViolation { "Reader::peek() returned " + std::to_string( views.size() )
+                                   + " views, more than the limit of " + std::to_string( max_views_ ) };
+    }
+    std::string got;
+    for ( const auto& view : views ) {
+      if ( view.empty() ) {
+        throw ExpectationViolation { "Reader::peek() returned an empty view" };
+      }
+      got += view;
+    }
+    if ( got != output_ ) {
+      throw ExpectationViolation { "Expected views of \"" + Printer::prettify( output_ ) + "\", but found \""
+                                   + Printer::prettify( got ) + "\"" };
+    }
+  }
+};
+
 struct IsClosed : public ConstExpectBool<ByteStream>
 {
   using ConstExpectBool::ConstExpectBool;
@@ -33,6 +33,9 @@ int main()
       test.execute( AvailableCapacity { 9 } );
       test.execute( BytesBuffered { 6 } );
       test.execute( Peek { "cattac" } );
+      test.execute( PeekViews { "cattac", 15, 4 } );
+      test.execute( PeekViews { "catt", 4, 4 } );
+      test.execute( PeekViews { "", 15, 0 } );
 
       test.execute( Close {} );
 
@@ -113,6 +116,7 @@ int main()
       test.execute( AvailableCapacity { 11 } );
       test.execute( BytesBuffered { 4 } );
       test.execute( Peek { "ttac" } );
+      test.execute( PeekViews { "ttac", 100, 1 } );
 
       test.execute( Pop { 4 } );
 
@@ -0,0 +1,323 @@
+#include "common.hh"
+#include "random.hh"
+#include "tcp_config.hh"
+#include "tcp_peer.hh"
+#include "tcp_segment.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <queue>
+#include <string>
+#include <utility>
+
+using namespace std;
+
+namespace {
+
+constexpr uint64_t MSS = TCPConfig::MAX_PAYLOAD_SIZE;
+
+struct PeerAndOutput
+{
+  TCPPeer peer;
+  queue<TCPMessage> output {};
+
+  TCPPeer::TransmitFunction make_transmit()
+  {
+    return [&]( TCPMessage x ) { output.push( move( x ) ); };
+  }
+};
+
+// A TCPPeer on the passive side of a connection, with initial sequence number `isn`
+class PeerTestHarness : public TestHarness<PeerAndOutput>
+{
+public:
+  PeerTestHarness( string test_name, Wrap32 isn, TCPConfig cfg = {} )
+    : TestHarness( move( test_name ), "ack_delay=" + to_string( cfg.ack_delay ), { with_isn( cfg, isn ), {} } )
+  {}
+
+private:
+  static TCPPeer with_isn( TCPConfig cfg, Wrap32 isn )
+  {
+    cfg.isn = isn;
+    return TCPPeer { cfg };
+  }
+};
+
+struct SegmentArrives : public Action<PeerAndOutput>
+{
+  TCPMessage msg_ {};
+
+  SegmentArrives( Wrap32 seqno, Wrap32 ackno )
+  {
+    msg_.sender.seqno = seqno;
+    msg_.receiver.ackno = ackno;
+    msg_.receiver.window_size = UINT16_MAX; // the remote end never limits what the peer sends
+  }
+
+  SegmentArrives& with_data( string data )
+  {
+    msg_.sender.payload = move( data );
+    return *this;
+  }
+
+  SegmentArrives& with_fin()
+  {
+    msg_.sender.FIN = true;
+    return *this;
+  }
+
+  string description() const override
+  {
+    return "segment arrives (seqno=" + to_string( msg_.sender.seqno ) + ", "
+           + to_string( msg_.sender.payload.size() ) + " bytes" + ( msg_.sender.FIN ? " +FIN" : "" ) + ")";
+  }
+
+  void execute( PeerAndOutput& p ) const override { p.peer.receive( msg_, p.make_transmit() ); }
+};
+
+struct Tick : public Action<PeerAndOutput>
+{
+  uint64_t ms_;
+  explicit Tick( uint64_t ms ) : ms_( ms ) {}
+  string description() const override { return to_string( ms_ ) + " ms pass"; }
+  void execute( PeerAndOutput& p ) const override { p.peer.tick( ms_, p.make_transmit() ); }
+};
+
+struct Write : public Action<PeerAndOutput>
+{
+  string data_;
+  explicit Write( string data ) : data_( move( data ) ) {}
+  string description() const override { return "write \"" + Printer::prettify( data_ ) + "\" and push"; }
+  void execute( PeerAndOutput& p ) const override
+  {
+    p.peer.outbound_writer().push( data_ );
+    p.peer.push( p.make_transmit() );
+  }
+};
+
+// the application reads `len` bytes and, if `notify`, tells the peer (which otherwise notices on its next tick)
+struct Read : public Action<PeerAndOutput>
+{
+  size_t len_;
+  bool notify_;
+  explicit Read( size_t len, bool notify = true ) : len_( len ), notify_( notify ) {}
+  string description() const override
+  {
+    return "application reads " + to_string( len_ ) + " bytes" + ( notify_ ? " and updates the window" : "" );
+  }
+  void execute( PeerAndOutput& p ) const override
+  {
+    p.peer.inbound_reader().pop( len_ );
+    if ( notify_ ) {
+      p.peer.update_window( p.make_transmit() );
+    }
+  }
+};
+
+// the next segment the peer sent acknowledges `ackno`, carrying `payload_size` bytes of its own
+struct ExpectAck : public Expectation<PeerAndOutput>
+{
+  Wrap32 ackno_;
+  uint64_t payload_size_;
+  optional<uint16_t> window_ {};
+
+  explicit ExpectAck( Wrap32 ackno, uint64_t payload_size = 0 ) : ackno_( ackno ), payload_size_( payload_size ) {}
+
+  ExpectAck& with_window( uint16_t window )
+  {
+    window_ = window;
+    return *this;
+  }
+
+  string description() const override
+  {
+    return "segment sent with ackno=" + to_string( ackno_ )
+           + ( window_.has_value() ? ", window=" + to_string( *window_ ) : "" )
+           + ( payload_size_ ? " and " + to_string( payload_size_ ) + " bytes of data" : " and no data" );
+  }
+
+  void execute( PeerAndOutput& p ) const override
+  {
+    if ( p.output.empty() ) {
+      throw ExpectationViolation( "TCPPeer should have sent a segment, but did not" );
+    }
+    const TCPMessage msg = move( p.output.front() );
+    p.output.pop();
+    if ( msg.receiver.ackno != ackno_ ) {
+      throw ExpectationViolation( "ackno", optional { ackno_ }, msg.receiver.ackno );
+    }
+    if ( window_.has_value() and msg.receiver.window_size != *window_ ) {
+      throw ExpectationViolation( "window", *window_, msg.receiver.window_size );
+    }
+    if ( msg.sender.payload.size() != payload_size_ ) {
+      throw ExpectationViolation( "payload size", payload_size_, msg.sender.payload.size() );
+    }
+  }
+};
+
+struct ExpectNoSegment : public Expectation<PeerAndOutput>
+{
+  string description() const override { return "no segment sent"; }
+  void execute( PeerAndOutput& p ) const override
+  {
+    if ( not p.output.empty() ) {
+      throw ExpectationViolation( "TCPPeer sent a segment (ackno="
+                                  + ( p.output.front().receiver.ackno.has_value()
+                                        ? to_string( p.output.front().receiver.ackno.value() )
+                                        : string { "none" } )
+                                  + ") when none was expected" );
+    }
+  }
+};
+
+// The remote peer's SYN and the ACK of ours, then enough segments to use up the quick ACKs.
+// Returns the next sequence number the remote peer will send.
+Wrap32 connect( PeerTestHarness& test, Wrap32 isn, Wrap32 remote_isn, bool use_up_quick_acks = true )
+{
+  SegmentArrives syn { remote_isn, isn };
+  syn.msg_.sender.SYN = true;
+  syn.msg_.sender.MSS = MSS;
+  syn.msg_.receiver.ackno.reset();
+  test.execute( syn );
+  test.execute( ExpectAck { remote_isn + 1 } );
+  test.execute( SegmentArrives { remote_isn + 1, isn + 1 } );
+  test.execute( ExpectNoSegment {} );
+
+  Wrap32 seqno = remote_isn + 1;
+  if ( use_up_quick_acks ) {
+    for ( int i = 0; i < 16; i++ ) {
+      test.execute( SegmentArrives { seqno, isn + 1 }.with_data( string( MSS, 'x' ) ) );
+      seqno = seqno + MSS;
+      test.execute( ExpectAck { seqno } );
+      test.execute( ExpectNoSegment {} );
+    }
+  }
+  return seqno;
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+    const string full( MSS, 'x' );
+
+    {
+      const Wrap32 isn( rd() ), remote_isn( rd() );
+      PeerTestHarness test { "The first segments are ACKed one by one", isn };
+      connect( test, isn, remote_isn );
+    }
+
+    {
+      const Wrap32 isn( rd() ), remote_isn( rd() );
+      PeerTestHarness test { "Every second full segment is ACKed", isn };
+      Wrap32 seqno = connect( test, isn, remote_isn );
+      for ( int i = 0; i < 3; i++ ) {
+        test.execute( SegmentArrives { seqno, isn + 1 }.with_data( full ) );
+        test.execute( ExpectNoSegment {} );
+        test.execute( SegmentArrives { seqno + MSS, isn + 1 }.with_data( full ) );
+        seqno = seqno + 2 * MSS;
+        test.execute( ExpectAck { seqno } );
+        test.execute( ExpectNoSegment {} );
+      }
+    }
+
+    {
+      const Wrap32 isn( rd() ), remote_isn( rd() );
+      PeerTestHarness test { "A lone segment is ACKed when the delay runs out", isn };
+      const Wrap32 seqno = connect( test, isn, remote_isn );
+      test.execute( SegmentArrives { seqno, isn + 1 }.with_data( "abc" ) );
+      test.execute( Tick { TCPConfig::ACK_DELAY_DFLT - 1 } );
+      test.execute( ExpectNoSegment {} );
+      // more data does not push the deadline back
+      test.execute( SegmentArrives { seqno + 3, isn + 1 }.with_data( "def" ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectAck { seqno + 6 } );
+      test.execute( Tick { 1000 } );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      const Wrap32 isn( rd() ), remote_isn( rd() );
+      PeerTestHarness test { "Out-of-order data and the segment filling the hole are ACKed at once", isn };
+      const Wrap32 seqno = connect( test, isn, remote_isn );
+      test.execute( SegmentArrives { seqno + MSS, isn + 1 }.with_data( full ) );
+      test.execute( ExpectAck { seqno } );
+      test.execute( SegmentArrives { seqno + 2 * MSS, isn + 1 }.with_data( full ) );
+      test.execute( ExpectAck { seqno } );
+      test.execute( SegmentArrives { seqno, isn + 1 }.with_data( full ) );
+      test.execute( ExpectAck { seqno + 3 * MSS } );
+      // data already received is a retransmission, and the sender wants to hear that promptly
+      test.execute( SegmentArrives { seqno, isn + 1 }.with_data( full ) );
+      test.execute( ExpectAck { seqno + 3 * MSS } );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      const Wrap32 isn( rd() ), remote_isn( rd() );
+      PeerTestHarness test { "A FIN is ACKed at once", isn };
+      const Wrap32 seqno = connect( test, isn, remote_isn );
+      test.execute( SegmentArrives { seqno, isn + 1 }.with_data( "abc" ).with_fin() );
+      test.execute( ExpectAck { seqno + 4 } );
+    }
+
+    {
+      const Wrap32 isn( rd() ), remote_isn( rd() );
+      PeerTestHarness test { "Outgoing data carries a pending ACK", isn };
+      const Wrap32 seqno = connect( test, isn, remote_isn );
+      test.execute( SegmentArrives { seqno, isn + 1 }.with_data( "abc" ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Write { "hello" } );
+      test.execute( ExpectAck { seqno + 3, 5 } );
+      test.execute( Tick { TCPConfig::ACK_DELAY_DFLT } );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      const Wrap32 isn( rd() ), remote_isn( rd() );
+      TCPConfig cfg;
+      cfg.ack_delay = 0;
+      PeerTestHarness test { "Every segment is ACKed when ACKs are not delayed", isn, cfg };
+      const Wrap32 seqno = connect( test, isn, remote_isn );
+      test.execute( SegmentArrives { seqno, isn + 1 }.with_data( "abc" ) );
+      test.execute( ExpectAck { seqno + 3 } );
+      test.execute( SegmentArrives { seqno + 3, isn + 1 }.with_data( full ) );
+      test.execute( ExpectAck { seqno + 3 + MSS } );
+    }
+
+    {
+      const Wrap32 isn( rd() ), remote_isn( rd() );
+      TCPConfig cfg;
+      cfg.recv_capacity = 4 * MSS;
+      PeerTestHarness test { "Reading from a full buffer sends a window update", isn, cfg };
+      Wrap32 seqno = connect( test, isn, remote_isn, false );
+      for ( uint16_t i = 1; i <= 4; i++ ) {
+        test.execute( SegmentArrives { seqno, isn + 1 }.with_data( full ) );
+        seqno = seqno + MSS;
+        test.execute( ExpectAck { seqno }.with_window( ( 4 - i ) * MSS ) );
+      }
+      test.execute( Read { MSS - 1 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Read { 1 } );
+      test.execute( ExpectAck { seqno }.with_window( MSS ) );
+      test.execute( ExpectNoSegment {} );
+      // without being told, the peer notices on its next tick
+      test.execute( Read { MSS, false } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectAck { seqno }.with_window( 2 * MSS ) );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectNoSegment {} );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
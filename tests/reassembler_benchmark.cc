@@ -0,0 +1,275 @@
+#include "reassembler.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+namespace {
+
+constexpr uint64_t SEGMENT_SIZE = 1000; // typical payload size for the segment-sized workloads
+
+struct Fragment
+{
+  uint64_t offset; // relative to the start of the block
+  uint64_t len;
+};
+
+struct Result
+{
+  uint64_t inserts {};
+  double gigabits_per_second {};
+  uint64_t worst_insert_ns {};
+  uint64_t peak_bytes_pending {};
+  size_t peak_fragments {};
+  uint64_t resent_bytes {}; // bytes that had to be inserted again because the Reassembler let them go
+};
+
+vector<Fragment> in_order( uint64_t block, uint64_t len )
+{
+  vector<Fragment> ret;
+  for ( uint64_t offset = 0; offset < block; offset += len ) {
+    ret.push_back( { offset, min( len, block - offset ) } );
+  }
+  return ret;
+}
+
+// The order in which one block (at most one window) of the stream arrives
+vector<Fragment> make_plan( const string& workload, uint64_t block, default_random_engine& rd )
+{
+  if ( workload.starts_with( "reorder-" ) ) {
+    // segments shuffled within consecutive groups of `depth`
+    const uint64_t depth = stoull( workload.substr( 8 ) );
+    auto plan = in_order( block, SEGMENT_SIZE );
+    for ( uint64_t i = 0; i < plan.size(); i += depth ) {
+      shuffle( plan.begin() + i, plan.begin() + min<uint64_t>( i + depth, plan.size() ), rd );
+    }
+    return plan;
+  }
+
+  if ( workload == "tiny" ) {
+    // single bytes in random order
+    auto plan = in_order( block, 1 );
+    shuffle( plan.begin(), plan.end(), rd );
+    return plan;
+  }
+
+  if ( workload == "hole-flood" ) {
+    // the first segment is lost, everything after it arrives, then the retransmission fills the hole
+    auto plan = in_order( block, SEGMENT_SIZE );
+    rotate( plan.begin(), plan.begin() + 1, plan.end() );
+    return plan;
+  }
+
+  if ( workload == "duplicates" ) {
+    // every segment of a shuffled group arrives twice
+    const auto segments = in_order( block, SEGMENT_SIZE );
+    vector<Fragment> plan;
+    for ( uint64_t i = 0; i < segments.size(); i += 8 ) {
+      vector<Fragment> group { segments.begin() + i, segments.begin() + min<uint64_t>( i + 8, segments.size() ) };
+      shuffle( group.begin(), group.end(), rd );
+      plan.insert( plan.end(), group.begin(), group.end() );
+      plan.insert( plan.end(), group.begin(), group.end() );
+    }
+    return plan;
+  }
+
+  if ( workload == "overlap-1" ) {
+    // segments that each overlap the previous one by a single byte, newest first
+    vector<Fragment> plan;
+    for ( uint64_t offset = 0; offset < block; offset += SEGMENT_SIZE - 1 ) {
+      plan.push_back( { offset, min( SEGMENT_SIZE, block - offset ) } );
+    }
+    reverse( plan.begin(), plan.end() );
+    return plan;
+  }
+
+  throw runtime_error( "unknown workload: " + workload );
+}
+
+Result run( Reassembler::Storage storage,
+            uint64_t capacity,
+            const string& workload,
+            const string& data,
+            uint64_t budget_limit )
+{
+  ReassemblyBudget budget { budget_limit };
+  Reassembler reassembler { ByteStream { capacity }, Reassembler::DEFAULT_MAX_FRAGMENTS, storage, &budget };
+  default_random_engine rd { 789 };
+  Result res;
+  nanoseconds total {};
+
+  auto deliver = [&]( uint64_t index, uint64_t len ) {
+    string payload { string_view { data }.substr( index, len ) };
+
+    const auto start = steady_clock::now();
+    reassembler.insert( index, move( payload ), index + len == data.size() );
+    const auto elapsed = steady_clock::now() - start;
+
+    ++res.inserts;
+    total += elapsed;
+    res.worst_insert_ns = max<uint64_t>( res.worst_insert_ns, duration_cast<nanoseconds>( elapsed ).count() );
+    res.peak_bytes_pending = max( res.peak_bytes_pending, reassembler.bytes_pending() );
+    res.peak_fragments = max( res.peak_fragments, reassembler.fragments_pending() );
+
+    Reader& reader = reassembler.reader();
+    const string_view ready = reader.peek();
+    if ( memcmp( ready.data(), data.data() + reader.bytes_popped(), ready.size() ) != 0 ) {
+      throw runtime_error( "Mismatch between data inserted and reassembled" );
+    }
+    reader.pop( ready.size() );
+  };
+
+  for ( uint64_t block_start = 0; block_start < data.size(); block_start += capacity ) {
+    const uint64_t block = min( capacity, data.size() - block_start );
+    for ( const auto& [offset, len] : make_plan( workload, block, rd ) ) {
+      deliver( block_start + offset, len );
+    }
+    // anything the Reassembler dropped comes back as one retransmission
+    while ( reassembler.writer().bytes_pushed() < block_start + block ) {
+      const uint64_t next = reassembler.writer().bytes_pushed();
+      res.resent_bytes += block_start + block - next;
+      deliver( next, block_start + block - next );
+    }
+  }
+
+  if ( not reassembler.reader().is_finished() ) {
+    throw runtime_error( "Reassembler did not finish the stream (" + workload + ")" );
+  }
+
+  const double seconds = duration_cast<duration<double>>( total ).count();
+  res.gigabits_per_second = 8 * static_cast<double>( data.size() ) / seconds / 1e9;
+  return res;
+}
+
+vector<string> parse_names( const char* arg )
+{
+  vector<string> ret;
+  istringstream in { arg };
+  for ( string item; getline( in, item, ',' ); ) {
+    ret.push_back( item );
+  }
+  return ret;
+}
+
+void show_usage( const char* argv0 )
+{
+  cerr << "Usage: " << argv0 << " [options]\n\n"
+       << "   --json                 Print results as JSON (default: CSV)\n"
+       << "   --storage <a,b>        fragments, window\n"
+       << "   --capacities <n,..>    Stream capacities in bytes\n"
+       << "   --workloads <a,b,..>   reorder-<depth>, tiny, hole-flood, duplicates, overlap-1\n"
+       << "   --volume <n>           Bytes reassembled per configuration\n"
+       << "   --budget <n>           Limit on out-of-order bytes held (default: none)\n";
+}
+
+void program_body( span<char*> args )
+{
+  bool json = false;
+  vector<string> storages { "fragments", "window" };
+  vector<string> capacities { "4096", "65536" };
+  vector<string> workloads { "reorder-4", "reorder-64", "tiny", "hole-flood", "duplicates", "overlap-1" };
+  uint64_t volume = 1 << 20;
+  uint64_t budget_limit = UINT64_MAX;
+
+  for ( size_t i = 1; i < args.size(); ++i ) {
+    const string_view opt = args[i];
+    if ( opt == "--json" ) {
+      json = true;
+      continue;
+    }
+    if ( opt == "-h" or opt == "--help" or i + 1 == args.size() ) {
+      show_usage( args[0] );
+      exit( opt == "-h" or opt == "--help" ? EXIT_SUCCESS : EXIT_FAILURE );
+    }
+    const char* value = args[++i];
+    if ( opt == "--storage" ) {
+      storages = parse_names( value );
+    } else if ( opt == "--capacities" ) {
+      capacities = parse_names( value );
+    } else if ( opt == "--workloads" ) {
+      workloads = parse_names( value );
+    } else if ( opt == "--volume" ) {
+      volume = stoull( value, nullptr, 0 );
+    } else if ( opt == "--budget" ) {
+      budget_limit = stoull( value, nullptr, 0 );
+    } else {
+      show_usage( args[0] );
+      exit( EXIT_FAILURE );
+    }
+  }
+
+  const string data = [&] {
+    default_random_engine rd { 1 };
+    uniform_int_distribution<char> ud;
+    string ret( volume, 0 );
+    generate( ret.begin(), ret.end(), [&] { return ud( rd ); } );
+    return ret;
+  }();
+
+  cout << fixed << setprecision( 3 );
+  if ( not json ) {
+    cout << "storage,capacity,workload,volume,inserts,gbit_per_s,worst_insert_ns,peak_bytes_pending,"
+            "peak_fragments,resent_bytes\n";
+  }
+  bool first = true;
+  for ( const auto& storage_name : storages ) {
+    if ( storage_name != "fragments" and storage_name != "window" ) {
+      throw runtime_error( "unknown storage: " + storage_name );
+    }
+    const auto storage
+      = storage_name == "window" ? Reassembler::Storage::Window : Reassembler::Storage::Fragments;
+    for ( const auto& capacity_str : capacities ) {
+      const uint64_t capacity = stoull( capacity_str, nullptr, 0 );
+      if ( capacity == 0 ) {
+        throw runtime_error( "capacity must be positive" );
+      }
+      for ( const auto& workload : workloads ) {
+        const Result res = run( storage, capacity, workload, data, budget_limit );
+        if ( json ) {
+          cout << ( first ? "[\n" : ",\n" ) << "  {\"storage\": \"" << storage_name << "\", \"capacity\": " << capacity
+               << ", \"workload\": \"" << workload << "\", \"volume\": " << volume
+               << ", \"inserts\": " << res.inserts << ", \"gbit_per_s\": " << res.gigabits_per_second
+               << ", \"worst_insert_ns\": " << res.worst_insert_ns
+               << ", \"peak_bytes_pending\": " << res.peak_bytes_pending
+               << ", \"peak_fragments\": " << res.peak_fragments << ", \"resent_bytes\": " << res.resent_bytes
+               << "}";
+        } else {
+          cout << storage_name << "," << capacity << "," << workload << "," << volume << "," << res.inserts << ","
+               << res.gigabits_per_second << "," << res.worst_insert_ns << "," << res.peak_bytes_pending << ","
+               << res.peak_fragments << "," << res.resent_bytes << "\n";
+        }
+        first = false;
+      }
+    }
+  }
+  if ( json ) {
+    cout << ( first ? "[]\n" : "\n]\n" );
+  }
+}
+
+} // namespace
+
+int main( int argc, char** argv )
+{
+  try {
+    program_body( span( argv, argc ) );
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
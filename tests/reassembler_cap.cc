@@ -2,6 +2,7 @@
 
 #include <exception>
 #include <iostream>
+#include <stdexcept>
 
 using namespace std;
 
@@ -145,6 +146,64 @@ int main()
       test.execute( ReadAll( "c" ) );
       test.execute( IsFinished { true } );
     }
+
+    {
+      ReassemblerTestHarness test { "fragment cap evicts the farthest fragment", 16, 2 };
+
+      test.execute( Insert { "c", 2 } );
+      test.execute( Insert { "g", 6 } );
+      test.execute( FragmentsPending( 2 ) );
+      test.execute( BytesPending( 2 ) );
+
+      test.execute( Insert { "i", 8 } ); // farther than everything held: dropped
+      test.execute( FragmentsPending( 2 ) );
+      test.execute( BytesPending( 2 ) );
+
+      test.execute( Insert { "e", 4 } ); // nearer: "g" is evicted to make room
+      test.execute( FragmentsPending( 2 ) );
+      test.execute( BytesPending( 2 ) );
+
+      test.execute( Insert { "cdef", 2 } ); // "c" is kept, "e" is absorbed into "def"
+      test.execute( FragmentsPending( 2 ) );
+      test.execute( BytesPending( 4 ) );
+
+      test.execute( Insert { "ab", 0 } );
+      test.execute( FragmentsPending( 0 ) );
+      test.execute( BytesPending( 0 ) );
+      test.execute( ReadAll( "abcdef" ) );
+    }
+
+    {
+      ReassemblyBudget budget { 6 };
+      Reassembler other {
+        ByteStream { 16 }, Reassembler::DEFAULT_MAX_FRAGMENTS, Reassembler::Storage::Fragments, &budget };
+      other.insert( 5, "xyz", false ); // another connection holds half the budget
+
+      ReassemblerTestHarness test { "shared budget prunes the farthest fragment", 16, budget };
+
+      test.execute( Insert { "gh", 6 } );
+      test.execute( Insert { "b", 1 } );
+      test.execute( BytesPending( 3 ) );
+      test.execute( BytesPruned( 0 ) );
+
+      test.execute( Insert { "d", 3 } ); // over budget: "gh" is pruned to make room
+      test.execute( BytesPending( 2 ) );
+      test.execute( FragmentsPending( 2 ) );
+      test.execute( BytesPruned( 2 ) );
+
+      test.execute( Insert { "ij", 8 } ); // over budget and farthest ahead: refused
+      test.execute( BytesPending( 2 ) );
+      test.execute( BytesPruned( 2 ) );
+
+      test.execute( Insert { "a", 0 } );
+      test.execute( Insert { "c", 2 } );
+      test.execute( BytesPending( 0 ) );
+      test.execute( ReadAll( "abcd" ) );
+
+      if ( budget.used() != 3 or budget.pruned_bytes() != 2 or budget.refused_bytes() != 2 ) {
+        throw runtime_error( "unexpected reassembly budget accounting" );
+      }
+    }
   } catch ( const exception& e ) {
     cerr << "Exception: " << e.what() << endl;
     return EXIT_FAILURE;
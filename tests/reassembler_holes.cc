@@ -129,6 +129,41 @@ int main()
       test.execute( ReadAll( "" ) );
       test.execute( IsFinished { true } );
     }
+
+    {
+      ReassemblerTestHarness test { "holes with window storage", 8, Reassembler::Storage::Window };
+
+      test.execute( Insert { "b", 1 } );
+      test.execute( Insert { "def", 3 } );
+      test.execute( BytesPushed( 0 ) );
+      test.execute( BytesPending( 4 ) );
+      test.execute( FragmentsPending( 2 ) );
+
+      test.execute( Insert { "bcde", 1 } );
+      test.execute( BytesPending( 5 ) );
+      test.execute( FragmentsPending( 1 ) );
+
+      test.execute( Insert { "a", 0 } );
+      test.execute( BytesPushed( 6 ) );
+      test.execute( BytesPending( 0 ) );
+      test.execute( FragmentsPending( 0 ) );
+      test.execute( ReadAll( "abcdef" ) );
+
+      // Run the stream long enough for the received-byte bitmap to wrap around several times
+      for ( uint64_t base = 6; base < 300; base += 6 ) {
+        test.execute( Insert { "yz", base + 4 } );
+        test.execute( Insert { "vwx", base + 1 } );
+        test.execute( BytesPending( 5 ) );
+        test.execute( FragmentsPending( 1 ) );
+        test.execute( Insert { "u", base } );
+        test.execute( BytesPending( 0 ) );
+        test.execute( ReadAll( "uvwxyz" ) );
+      }
+
+      test.execute( Insert { "end", 300 }.is_last() );
+      test.execute( ReadAll( "end" ) );
+      test.execute( IsFinished { true } );
+    }
   } catch ( const exception& e ) {
     cerr << "Exception: " << e.what() << endl;
     return EXIT_FAILURE;
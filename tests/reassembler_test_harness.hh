@@ -33,6 +33,28 @@ public:
                    { Reassembler { ByteStream { capacity } } } )
   {}
 
+  ReassemblerTestHarness( std::string test_name, uint64_t capacity, size_t max_fragments )
+    : TestHarness( move( test_name ),
+                   "capacity=" + std::to_string( capacity ) + ", max_fragments=" + std::to_string( max_fragments ),
+                   { Reassembler { ByteStream { capacity }, max_fragments } } )
+  {}
+
+  ReassemblerTestHarness( std::string test_name, uint64_t capacity, Reassembler::Storage storage )
+    : TestHarness( move( test_name ),
+                   "capacity=" + std::to_string( capacity )
+                     + ( storage == Reassembler::Storage::Window ? ", window storage" : "" ),
+                   { Reassembler { ByteStream { capacity }, Reassembler::DEFAULT_MAX_FRAGMENTS, storage } } )
+  {}
+
+  ReassemblerTestHarness( std::string test_name, uint64_t capacity, ReassemblyBudget& budget )
+    : TestHarness( move( test_name ),
+                   "capacity=" + std::to_string( capacity ) + ", budget=" + std::to_string( budget.limit() ),
+                   { Reassembler { ByteStream { capacity },
+                                   Reassembler::DEFAULT_MAX_FRAGMENTS,
+                                   Reassembler::Storage::Fragments,
+                                   &budget } } )
+  {}
+
   template<std::derived_from<TestStep<ByteStream>> T>
   void execute( const T& test )
   {
@@ -49,6 +71,20 @@ struct BytesPending : public ConstExpectNumber<Reassembler, uint64_t>
   uint64_t value( const Reassembler& r ) const override { return r.bytes_pending(); }
 };
 
+struct FragmentsPending : public ConstExpectNumber<Reassembler, size_t>
+{
+  using ConstExpectNumber::ConstExpectNumber;
+  std::string name() const override { return "fragments_pending"; }
+  size_t value( const Reassembler& r ) const override { return r.fragments_pending(); }
+};
+
+struct BytesPruned : public ConstExpectNumber<Reassembler, uint64_t>
+{
+  using ConstExpectNumber::ConstExpectNumber;
+  std::string name() const override { return "bytes_pruned"; }
+  uint64_t value( const Reassembler& r ) const override { return r.bytes_pruned(); }
+};
+
 struct Insert : public Action<Reassembler>
 {
   std::string data_;
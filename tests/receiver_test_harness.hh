@@ -8,6 +8,7 @@
 #include <optional>
 #include <sstream>
 #include <utility>
+#include <vector>
 
 template<std::derived_from<TestStep<Reassembler>> T>
 struct DirectReassemblerTest : public TestStep<TCPReceiver>
@@ -37,6 +38,12 @@ struct DirectByteStreamTest : public TestStep<TCPReceiver>
   void execute( TCPReceiver& sr ) const override { step_.execute( sr.reader() ); }
 };
 
+// receiver-side silly window syndrome avoidance, for segments of up to `mss` bytes
+struct SillyWindowAvoidance
+{
+  uint64_t mss;
+};
+
 class TCPReceiverTestHarness : public TestHarness<TCPReceiver>
 {
 public:
@@ -46,6 +53,34 @@ public:
                    { TCPReceiver { Reassembler { ByteStream { capacity } } } } )
   {}
 
+  TCPReceiverTestHarness( std::string test_name, uint64_t capacity, bool sack )
+    : TestHarness( move( test_name ),
+                   "capacity=" + std::to_string( capacity ) + ", sack=" + ( sack ? "on" : "off" ),
+                   { TCPReceiver { Reassembler { ByteStream { capacity } }, sack } } )
+  {}
+
+  TCPReceiverTestHarness( std::string test_name, uint64_t capacity, std::optional<uint8_t> window_shift )
+    : TestHarness( move( test_name ),
+                   "capacity=" + std::to_string( capacity ) + ", window_shift="
+                     + ( window_shift.has_value() ? std::to_string( *window_shift ) : "none" ),
+                   { TCPReceiver { Reassembler { ByteStream { capacity } }, false, window_shift } } )
+  {}
+
+  TCPReceiverTestHarness( std::string test_name, uint64_t capacity, TCPReceiver::ECNEcho ecn )
+    : TestHarness( move( test_name ),
+                   "capacity=" + std::to_string( capacity ) + ", ecn="
+                     + ( ecn == TCPReceiver::ECNEcho::None       ? "off"
+                         : ecn == TCPReceiver::ECNEcho::UntilCWR ? "until CWR"
+                                                                 : "per segment" ),
+                   { TCPReceiver { Reassembler { ByteStream { capacity } }, false, {}, ecn } } )
+  {}
+
+  TCPReceiverTestHarness( std::string test_name, uint64_t capacity, SillyWindowAvoidance sws )
+    : TestHarness( move( test_name ),
+                   "capacity=" + std::to_string( capacity ) + ", sws_mss=" + std::to_string( sws.mss ),
+                   { TCPReceiver { Reassembler { ByteStream { capacity } }, false, {}, {}, sws.mss } } )
+  {}
+
   template<std::derived_from<TestStep<Reassembler>> T>
   void execute( const T& test )
   {
@@ -111,6 +146,46 @@ struct ExpectAcknoBetween : public Expectation<TCPReceiver>
   }
 };
 
+struct ExpectSackBlocks : public Expectation<TCPReceiver>
+{
+  std::vector<SackBlock> blocks_;
+
+  explicit ExpectSackBlocks( std::vector<SackBlock> blocks ) : blocks_( std::move( blocks ) ) {}
+
+  std::string description() const override
+  {
+    std::ostringstream ss;
+    ss << "SACK blocks are {";
+    for ( const auto& block : blocks_ ) {
+      ss << " [" << block.begin << ", " << block.end << ")";
+    }
+    ss << " }";
+    return ss.str();
+  }
+
+  void execute( TCPReceiver& rs ) const override
+  {
+    const TCPReceiverMessage msg = rs.send();
+    if ( msg.sack().size() != blocks_.size() ) {
+      throw ExpectationViolation( "number of SACK blocks", blocks_.size(), msg.sack().size() );
+    }
+    for ( size_t i = 0; i < blocks_.size(); i++ ) {
+      if ( msg.sack()[i].begin != blocks_[i].begin or msg.sack()[i].end != blocks_[i].end ) {
+        throw ExpectationViolation( "SACK block #" + std::to_string( i ) + " was ["
+                                    + to_string( msg.sack()[i].begin ) + ", " + to_string( msg.sack()[i].end )
+                                    + ")" );
+      }
+    }
+  }
+};
+
+struct ExpectECE : public ExpectBool<TCPReceiver>
+{
+  using ExpectBool::ExpectBool;
+  std::string name() const override { return "ECE"; }
+  bool value( TCPReceiver& rs ) const override { return rs.send().ECE; }
+};
+
 struct HasAckno : public ExpectBool<TCPReceiver>
 {
   using ExpectBool::ExpectBool;
@@ -135,12 +210,42 @@ struct SegmentArrives : public Action<TCPReceiver>
     return *this;
   }
 
+  SegmentArrives& with_sack_permitted()
+  {
+    msg_.SACK_permitted = true;
+    return *this;
+  }
+
+  SegmentArrives& with_window_scale( uint8_t shift )
+  {
+    msg_.window_scale = shift;
+    return *this;
+  }
+
   SegmentArrives& with_rst()
   {
     msg_.RST = true;
     return *this;
   }
 
+  SegmentArrives& with_ecn()
+  {
+    msg_.ECN = true;
+    return *this;
+  }
+
+  SegmentArrives& with_cwr()
+  {
+    msg_.CWR = true;
+    return *this;
+  }
+
+  SegmentArrives& with_ce()
+  {
+    msg_.CE = true;
+    return *this;
+  }
+
   SegmentArrives& with_seqno( Wrap32 seqno_ )
   {
     msg_.seqno = seqno_;
@@ -175,6 +280,21 @@ struct SegmentArrives : public Action<TCPReceiver>
     if ( msg_.SYN ) {
       ss << " +SYN";
     }
+    if ( msg_.SACK_permitted ) {
+      ss << " +SACK-permitted";
+    }
+    if ( msg_.window_scale.has_value() ) {
+      ss << " wscale=" << static_cast<int>( *msg_.window_scale );
+    }
+    if ( msg_.ECN ) {
+      ss << " +ECN";
+    }
+    if ( msg_.CWR ) {
+      ss << " +CWR";
+    }
+    if ( msg_.CE ) {
+      ss << " (CE)";
+    }
     if ( not msg_.payload.empty() ) {
       ss << " payload=\"" << Printer::prettify( msg_.payload ) << "\"";
     }
@@ -0,0 +1,74 @@
+#include "random.hh"
+#include "receiver_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+    using ECNEcho = TCPReceiver::ECNEcho;
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "Classic ECE lasts until the sender's CWR", 4000, ECNEcho::UntilCWR };
+      test.execute( SegmentArrives {}.with_syn().with_ecn().with_seqno( isn ) );
+      test.execute( ExpectECE { false } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "abc" ) );
+      test.execute( ExpectECE { false } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 4 ).with_data( "def" ).with_ce() );
+      test.execute( ExpectECE { true } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 7 ).with_data( "ghi" ) );
+      test.execute( ExpectECE { true } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 10 ).with_data( "jkl" ).with_cwr() );
+      test.execute( ExpectECE { false } );
+      // a CWR segment that is itself marked keeps the echo going
+      test.execute( SegmentArrives {}.with_seqno( isn + 13 ).with_data( "mno" ).with_ce() );
+      test.execute( SegmentArrives {}.with_seqno( isn + 16 ).with_data( "pqr" ).with_cwr().with_ce() );
+      test.execute( ExpectECE { true } );
+      test.execute( ReadAll { "abcdefghijklmnopqr" } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "DCTCP echoes each segment's mark", 4000, ECNEcho::PerSegment };
+      test.execute( SegmentArrives {}.with_syn().with_ecn().with_seqno( isn ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "abc" ).with_ce() );
+      test.execute( ExpectECE { true } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 4 ).with_data( "def" ) );
+      test.execute( ExpectECE { false } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 7 ).with_data( "ghi" ).with_ce() );
+      test.execute( ExpectECE { true } );
+      // a bare ACK carries no mark of its own
+      test.execute( SegmentArrives {}.with_seqno( isn + 10 ) );
+      test.execute( ExpectECE { true } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "No ECE unless the peer's SYN requested ECN", 4000, ECNEcho::UntilCWR };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "abc" ).with_ce() );
+      test.execute( ExpectECE { false } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "No ECE when ECN is off", 4000, ECNEcho::None };
+      test.execute( SegmentArrives {}.with_syn().with_ecn().with_seqno( isn ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "abc" ).with_ce() );
+      test.execute( ExpectECE { false } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,75 @@
+#include "random.hh"
+#include "receiver_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "SACK blocks report held data, newest first", 4000, true };
+      test.execute( SegmentArrives {}.with_syn().with_sack_permitted().with_seqno( isn ) );
+      test.execute( ExpectSackBlocks { {} } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 6 ).with_data( "fgh" ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 1 } } );
+      test.execute( ExpectSackBlocks { { { Wrap32 { isn + 6 }, Wrap32 { isn + 9 } } } } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 21 ).with_data( "uv" ) );
+      test.execute( ExpectSackBlocks {
+        { { Wrap32 { isn + 21 }, Wrap32 { isn + 23 } }, { Wrap32 { isn + 6 }, Wrap32 { isn + 9 } } } } );
+
+      // a segment adjacent to a block extends it, and that block moves to the front
+      test.execute( SegmentArrives {}.with_seqno( isn + 3 ).with_data( "cde" ) );
+      test.execute( ExpectSackBlocks {
+        { { Wrap32 { isn + 3 }, Wrap32 { isn + 9 } }, { Wrap32 { isn + 21 }, Wrap32 { isn + 23 } } } } );
+
+      // filling the first hole acknowledges the block instead
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "ab" ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 9 } } );
+      test.execute( ExpectSackBlocks { { { Wrap32 { isn + 21 }, Wrap32 { isn + 23 } } } } );
+      test.execute( ReadAll { "abcdefgh" } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "At most four SACK blocks", 4000, true };
+      test.execute( SegmentArrives {}.with_syn().with_sack_permitted().with_seqno( isn ) );
+      for ( uint32_t i = 1; i <= 5; i++ ) {
+        test.execute( SegmentArrives {}.with_seqno( isn + 1 + 10 * i ).with_data( "x" ) );
+      }
+      test.execute( ExpectSackBlocks { { { Wrap32 { isn + 51 }, Wrap32 { isn + 52 } },
+                                         { Wrap32 { isn + 11 }, Wrap32 { isn + 12 } },
+                                         { Wrap32 { isn + 21 }, Wrap32 { isn + 22 } },
+                                         { Wrap32 { isn + 31 }, Wrap32 { isn + 32 } } } } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "No SACK unless the peer permitted it", 4000, true };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 6 ).with_data( "fgh" ) );
+      test.execute( ExpectSackBlocks { {} } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "No SACK when disabled locally", 4000, false };
+      test.execute( SegmentArrives {}.with_syn().with_sack_permitted().with_seqno( isn ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 6 ).with_data( "fgh" ) );
+      test.execute( ExpectSackBlocks { {} } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
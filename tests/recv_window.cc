@@ -105,6 +105,43 @@ int main()
       test.execute( BytesPending( 0 ) );
     }
 
+    {
+      const size_t cap = 4000;
+      const uint32_t isn = 23452;
+      TCPReceiverTestHarness test {
+        "small window openings are not advertised", cap, SillyWindowAvoidance { 1000 } };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( ExpectWindow { cap } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( string( 3000, 'x' ) ) );
+      test.execute( ExpectWindow { 1000 } );
+      test.execute( Pop { 500 } );
+      test.execute( ExpectWindow { 1000 } );
+      test.execute( Pop { 499 } );
+      test.execute( ExpectWindow { 1000 } );
+      test.execute( Pop { 1 } );
+      test.execute( ExpectWindow { 2000 } );
+      test.execute( Pop { 600 } );
+      test.execute( ExpectWindow { 2000 } );
+      test.execute( ExpectAckno { Wrap32 { isn + 3001 } } );
+    }
+
+    {
+      const size_t cap = 10;
+      const uint32_t isn = 23452;
+      TCPReceiverTestHarness test {
+        "a closed window reopens by half the buffer", cap, SillyWindowAvoidance { 1000 } };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "abcdefghij" ) );
+      test.execute( ExpectWindow { 0 } );
+      test.execute( Pop { 4 } );
+      test.execute( ExpectWindow { 0 } );
+      test.execute( Pop { 1 } );
+      test.execute( ExpectWindow { 5 } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 11 ).with_data( "klm" ) );
+      test.execute( ExpectWindow { 2 } );
+      test.execute( ReadAll { "fghijklm" } );
+    }
+
   } catch ( const exception& e ) {
     cerr << e.what() << endl;
     return 1;
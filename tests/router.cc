@@ -7,6 +7,7 @@
 #include <list>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 using namespace std;
 
@@ -94,7 +95,7 @@ public:
     , _next_hop( next_hop )
   {}
 
-  InternetDatagram send_to( const Address& destination, const uint8_t ttl = 64 )
+  InternetDatagram send_to( const Address& destination, const uint8_t ttl = 64, const uint8_t tos = 0 )
   {
     InternetDatagram dgram;
     dgram.header.src = _my_address.ipv4_numeric();
@@ -102,6 +103,7 @@ public:
     dgram.payload.emplace_back( string { "Cardinal " + to_string( random_device()() % 1000 ) } );
     dgram.header.len = static_cast<uint64_t>( dgram.header.hlen ) * 4 + dgram.payload.back().size();
     dgram.header.ttl = ttl;
+    dgram.header.tos = tos;
     dgram.header.compute_checksum();
 
     cerr << "Host " << _name << " trying to send datagram (with next hop = " << _next_hop.ip()
@@ -231,6 +233,8 @@ public:
     }
   }
 
+  Router& router() { return _router; }
+
   Host& host( const string& name )
   {
     auto it = _hosts.find( name );
@@ -327,6 +331,29 @@ void network_simulator()
     network.simulate();
   }
 
+  cout << green << "\n\nSuccess! Testing ECN marking of a standing queue..." << normal << "\n\n";
+  {
+    // four datagrams wait at the router together; those routed while more than one is queued get marked,
+    // unless they are not ECN-capable
+    network.router().set_ecn_threshold( 1 );
+    const Address& dst = network.host( "cherrypie" ).address();
+    vector<InternetDatagram> sent;
+    sent.push_back( network.host( "applesauce" ).send_to( dst, 64, IPv4Header::ECN_ECT0 ) );
+    sent.push_back( network.host( "applesauce" ).send_to( dst, 64, IPv4Header::ECN_ECT0 ) );
+    sent.push_back( network.host( "applesauce" ).send_to( dst, 64, IPv4Header::ECN_NOT_ECT ) );
+    sent.push_back( network.host( "applesauce" ).send_to( dst, 64, IPv4Header::ECN_ECT0 ) );
+    for ( size_t i = 0; i < sent.size(); i++ ) {
+      sent[i].header.ttl--;
+      if ( i < 2 ) {
+        sent[i].header.set_ecn( IPv4Header::ECN_CE );
+      }
+      sent[i].header.compute_checksum();
+      network.host( "cherrypie" ).expect( sent[i] );
+    }
+    network.simulate();
+    network.router().set_ecn_threshold( {} );
+  }
+
   cout << "\n\n\033[32;1mCongratulations! All datagrams were routed successfully.\033[m\n";
 }
 
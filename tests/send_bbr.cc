@@ -0,0 +1,288 @@
+#include "congestion_controller.hh"
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <utility>
+
+using namespace std;
+
+namespace {
+
+class BBRTestHarness : public TestHarness<BBR>
+{
+public:
+  BBRTestHarness( string test_name, uint64_t mss )
+    : TestHarness( move( test_name ), "mss=" + to_string( mss ), BBR { mss } )
+  {}
+};
+
+struct SampleArrives : public Action<BBR>
+{
+  RateSample rs_;
+  explicit SampleArrives( RateSample rs ) : rs_( rs ) {}
+  string description() const override
+  {
+    return "rate sample at " + to_string( rs_.now_ms ) + " ms: " + to_string( rs_.delivery_rate ) + " B/s"
+           + ( rs_.app_limited ? " (app-limited)" : "" ) + ", rtt " + to_string( rs_.rtt_ms.value_or( 0 ) )
+           + " ms, " + to_string( rs_.bytes_in_flight ) + " in flight";
+  }
+  void execute( BBR& bbr ) const override { bbr.on_rate_sample( rs_ ); }
+};
+
+struct LossDetected : public Action<BBR>
+{
+  string description() const override { return "loss detected"; }
+  void execute( BBR& bbr ) const override { bbr.on_loss( 0 ); }
+};
+
+string mode_name( BBR::Mode mode )
+{
+  switch ( mode ) {
+    case BBR::Mode::Startup:
+      return "Startup";
+    case BBR::Mode::Drain:
+      return "Drain";
+    case BBR::Mode::ProbeBW:
+      return "ProbeBW";
+    case BBR::Mode::ProbeRTT:
+      return "ProbeRTT";
+  }
+  return "unknown";
+}
+
+struct ExpectMode : public Expectation<BBR>
+{
+  BBR::Mode mode_;
+  explicit ExpectMode( BBR::Mode mode ) : mode_( mode ) {}
+  string description() const override { return "mode = " + mode_name( mode_ ); }
+  void execute( BBR& bbr ) const override
+  {
+    if ( bbr.mode() != mode_ ) {
+      throw ExpectationViolation { "The controller should have been in " + mode_name( mode_ )
+                                   + ", but instead it was in " + mode_name( bbr.mode() ) + "." };
+    }
+  }
+};
+
+struct ExpectBBRWindow : public ExpectNumber<BBR, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  string name() const override { return "cwnd"; }
+  uint64_t value( BBR& bbr ) const override { return bbr.cwnd(); }
+};
+
+struct ExpectBBRPacingRate : public ExpectNumber<BBR, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  string name() const override { return "pacing_rate"; }
+  uint64_t value( BBR& bbr ) const override { return bbr.pacing_rate(); }
+};
+
+struct ExpectBottleneckBandwidth : public ExpectNumber<BBR, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  string name() const override { return "bottleneck_bandwidth"; }
+  uint64_t value( BBR& bbr ) const override { return bbr.bottleneck_bandwidth(); }
+};
+
+// a path that delivers `bytes` per round trip, the whole flight acknowledged at once
+class Path
+{
+  uint64_t now_ms_ {};
+  uint64_t delivered_ {};
+
+public:
+  uint64_t now_ms() const { return now_ms_; }
+
+  SampleArrives round( uint64_t bytes, uint64_t rtt_ms, uint64_t in_flight = 0, bool app_limited = false )
+  {
+    RateSample rs;
+    rs.prior_delivered = delivered_;
+    delivered_ += bytes;
+    now_ms_ += rtt_ms;
+    rs.now_ms = now_ms_;
+    rs.delivered = delivered_;
+    rs.newly_delivered = bytes;
+    rs.interval_ms = rtt_ms;
+    rs.delivery_rate = bytes * 1000 / rtt_ms;
+    rs.rtt_ms = rtt_ms;
+    rs.bytes_in_flight = in_flight;
+    rs.app_limited = app_limited;
+    return SampleArrives { rs };
+  }
+};
+
+constexpr uint64_t MSS = 1000;
+constexpr uint64_t RTT = 10;
+
+// Startup at 2 segments per 10 ms until three rounds pass without growth; leaves the controller in ProbeBW
+void fill_pipe( BBRTestHarness& test, Path& path )
+{
+  for ( int i = 0; i < 3; i++ ) {
+    test.execute( path.round( 2 * MSS, RTT ) );
+    test.execute( ExpectMode { BBR::Mode::Startup } );
+  }
+  test.execute( path.round( 2 * MSS, RTT ) );
+  test.execute( ExpectMode { BBR::Mode::ProbeBW } );
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      BBRTestHarness test { "Startup paces at high gain from the first RTT sample", MSS };
+      Path path;
+      test.execute( ExpectBBRPacingRate { 0 } );
+      test.execute( path.round( 2 * MSS, RTT ) );
+      // 2.89 x the initial window per round trip; the low first sample does not lower it
+      test.execute( ExpectBBRPacingRate { 2890000 } );
+      test.execute( ExpectBBRWindow { 12 * MSS } );
+      test.execute( path.round( 20 * MSS, RTT ) );
+      test.execute( ExpectBottleneckBandwidth { 2000000 } );
+      test.execute( ExpectBBRPacingRate { 5780000 } );
+      test.execute( ExpectBBRWindow { 32 * MSS } );
+    }
+
+    {
+      BBRTestHarness test { "Startup ends after three rounds without growth", MSS };
+      Path path;
+      fill_pipe( test, path );
+      // Drain finished at once: nothing was in flight. Pace at the bottleneck rate, cwnd 2 BDP + 3 segments
+      test.execute( ExpectBottleneckBandwidth { 200000 } );
+      test.execute( ExpectBBRPacingRate { 200000 } );
+      test.execute( ExpectBBRWindow { 7 * MSS } );
+    }
+
+    {
+      BBRTestHarness test { "Growing bandwidth keeps Startup going", MSS };
+      Path path;
+      uint64_t segments = 2;
+      for ( int i = 0; i < 8; i++ ) {
+        test.execute( path.round( segments * MSS, RTT ) );
+        test.execute( ExpectMode { BBR::Mode::Startup } );
+        segments *= 2;
+      }
+    }
+
+    {
+      BBRTestHarness test { "App-limited rounds do not count towards a full pipe", MSS };
+      Path path;
+      test.execute( path.round( 2 * MSS, RTT ) );
+      for ( int i = 0; i < 6; i++ ) {
+        test.execute( path.round( 2 * MSS, RTT, 0, true ) );
+        test.execute( ExpectMode { BBR::Mode::Startup } );
+      }
+    }
+
+    {
+      BBRTestHarness test { "Drain waits for the queue to empty", MSS };
+      Path path;
+      for ( int i = 0; i < 4; i++ ) {
+        test.execute( path.round( 2 * MSS, RTT, 5 * MSS ) );
+      }
+      test.execute( ExpectMode { BBR::Mode::Drain } );
+      test.execute( ExpectBBRPacingRate { 70000 } );
+      test.execute( path.round( 2 * MSS, RTT, 2 * MSS ) );
+      test.execute( ExpectMode { BBR::Mode::ProbeBW } );
+    }
+
+    {
+      BBRTestHarness test { "ProbeBW probes, drains and cruises", MSS };
+      Path path;
+      fill_pipe( test, path );
+      // the rest of the unity-gain phases, each a little longer than the min RTT
+      for ( int i = 0; i < 5; i++ ) {
+        test.execute( path.round( 2200, RTT + 1 ) );
+        test.execute( ExpectBBRPacingRate { 200000 } );
+      }
+      test.execute( path.round( 2200, RTT + 1 ) );
+      test.execute( ExpectBBRPacingRate { 250000 } );
+      // the probe lasts until the flight reaches 1.25 BDP (or a loss)
+      test.execute( path.round( 2200, RTT + 1 ) );
+      test.execute( ExpectBBRPacingRate { 250000 } );
+      test.execute( path.round( 2200, RTT + 1, 2500 ) );
+      test.execute( ExpectBBRPacingRate { 150000 } );
+      // the drain phase ends early once the flight is back to one BDP
+      test.execute( path.round( 2 * MSS, RTT, 2 * MSS ) );
+      test.execute( ExpectBBRPacingRate { 200000 } );
+    }
+
+    {
+      BBRTestHarness test { "A loss ends the probe without shrinking the window", MSS };
+      Path path;
+      fill_pipe( test, path );
+      for ( int i = 0; i < 6; i++ ) {
+        test.execute( path.round( 2200, RTT + 1 ) );
+      }
+      test.execute( ExpectBBRPacingRate { 250000 } );
+      test.execute( LossDetected {} );
+      test.execute( ExpectBBRWindow { 7 * MSS } );
+      test.execute( path.round( 2200, RTT + 1 ) );
+      test.execute( ExpectBBRPacingRate { 150000 } );
+    }
+
+    {
+      BBRTestHarness test { "ProbeRTT after ten seconds without a lower RTT", MSS };
+      Path path;
+      fill_pipe( test, path );
+      // the min RTT was last seen at the end of Startup; the queue has grown since
+      const uint64_t expiry = path.now_ms() + BBR::MIN_RTT_WINDOW_MS;
+      while ( path.now_ms() + 2 * RTT <= expiry ) {
+        test.execute( path.round( 4 * MSS, 2 * RTT ) );
+        test.execute( ExpectMode { BBR::Mode::ProbeBW } );
+      }
+      test.execute( ExpectBBRWindow { 7 * MSS } );
+      test.execute( path.round( 4 * MSS, 2 * RTT, 8 * MSS ) );
+      test.execute( ExpectMode { BBR::Mode::ProbeRTT } );
+      test.execute( ExpectBBRWindow { 4 * MSS } );
+      // 200 ms from when the flight fits in four segments, and at least one round
+      test.execute( path.round( 4 * MSS, 2 * RTT, 4 * MSS ) );
+      for ( uint64_t t = 0; t + 2 * RTT < BBR::PROBE_RTT_MS; t += 2 * RTT ) {
+        test.execute( path.round( 4 * MSS, 2 * RTT ) );
+        test.execute( ExpectMode { BBR::Mode::ProbeRTT } );
+      }
+      test.execute( path.round( 4 * MSS, 2 * RTT ) );
+      // the window comes back, then grows to 2 BDP at the newly measured 20 ms
+      test.execute( ExpectMode { BBR::Mode::ProbeBW } );
+      test.execute( ExpectBBRWindow { 11 * MSS } );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg;
+      cfg.isn = isn;
+      cfg.congestion_control = TCPConfig::CongestionControl::BBR;
+      TCPSenderTestHarness test { "The sender paces BBR without -P", cfg, FromConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( Tick { 10 } );
+      test.execute( Receive { { isn + 1, 60000 } } );
+      test.execute( ExpectPacingRate { 2890000 } );
+      test.execute( Push { string( 4 * TCPConfig::MAX_PAYLOAD_SIZE, 'x' ) } );
+      // the SYN took a byte of the two-segment burst
+      test.execute( ExpectMessage {}.with_payload_size( TCPConfig::MAX_PAYLOAD_SIZE ) );
+      test.execute( ExpectNoSegment {} );
+      // 2890 bytes of tokens per millisecond
+      test.execute( Tick { 1 } );
+      for ( int i = 0; i < 3; i++ ) {
+        test.execute( ExpectMessage {}.with_payload_size( TCPConfig::MAX_PAYLOAD_SIZE ) );
+      }
+      test.execute( ExpectNoSegment {} );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
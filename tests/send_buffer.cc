@@ -0,0 +1,63 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg;
+      cfg.isn = isn;
+      cfg.send_capacity = 10;
+      TCPSenderTestHarness test { "Unacknowledged bytes stay in the send buffer", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { isn + 1 }.with_win( 1000 ) );
+      test.execute( Push { "abcdef" } );
+      test.execute( ExpectMessage {}.with_data( "abcdef" ) );
+      test.execute( ExpectAvailableCapacity { 4 } );
+      test.execute( AckReceived { isn + 4 }.with_win( 1000 ) );
+      test.execute( ExpectAvailableCapacity { 4 } );
+      test.execute( AckReceived { isn + 7 }.with_win( 1000 ) );
+      test.execute( ExpectAvailableCapacity { 10 } );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg;
+      cfg.isn = isn;
+      TCPSenderTestHarness test { "Retransmissions are rebuilt from the send buffer", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { isn + 1 }.with_win( 6 ) );
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ) );
+      test.execute( Push { "defghi" } );
+      test.execute( ExpectMessage {}.with_data( "def" ) );
+      test.execute( AckReceived { isn + 4 }.with_win( 6 ) );
+      test.execute( ExpectMessage {}.with_data( "ghi" ) );
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectMessage {}.with_data( "def" ).with_seqno( isn + 4 ) );
+      test.execute( Close {} );
+      test.execute( AckReceived { isn + 10 }.with_win( 6 ) );
+      test.execute( ExpectMessage {}.with_fin( true ).with_seqno( isn + 10 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
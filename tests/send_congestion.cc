@@ -0,0 +1,195 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+namespace {
+
+void expect_segments( TCPSenderTestHarness& test, uint64_t count )
+{
+  for ( uint64_t i = 0; i < count; i++ ) {
+    test.execute( ExpectMessage {}.with_payload_size( TCPConfig::MAX_PAYLOAD_SIZE ) );
+  }
+  test.execute( ExpectNoSegment {} );
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+    const uint64_t mss = TCPConfig::MAX_PAYLOAD_SIZE;
+
+    // min(10 * MSS, max(2 * MSS, 14600)) (RFC 6928)
+    for ( const auto& [segment_size, window] : { pair<uint16_t, uint64_t> { 536, 5360 },
+                                                 pair<uint16_t, uint64_t> { 1000, 10000 },
+                                                 pair<uint16_t, uint64_t> { 1460, 14600 },
+                                                 pair<uint16_t, uint64_t> { 4000, 14600 } } ) {
+      TCPConfig cfg = sender_config( Wrap32( rd() ), 2 * WINDOW );
+      cfg.mss = segment_size;
+      TCPSenderTestHarness test { "Initial window for MSS " + to_string( segment_size ), cfg, FromConfig {} };
+      test.execute( ExpectCongestionWindow { window } );
+      test.execute( ExpectSlowStartThreshold { UINT64_MAX } );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPSenderTestHarness test {
+        "The first flight fills the initial window", sender_config( isn, 2 * WINDOW ), FromConfig {} };
+      connect( test, isn );
+      test.execute( Push { string( 20 * mss, 'x' ) } );
+      expect_segments( test, 10 );
+      test.execute( ExpectSeqnosInFlight { 10 * mss } );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPSenderTestHarness test { "Slow start grows by the bytes acked, at most 2 MSS per ACK",
+                                  sender_config( isn, 2 * WINDOW ),
+                                  FromConfig {} };
+      connect( test, isn );
+      const Wrap32 a = isn + 1;
+      test.execute( Push { string( 40 * mss, 'x' ) } );
+      expect_segments( test, 10 );
+      test.execute( Tick { 10 } );
+      test.execute( ack( a + mss ) );
+      test.execute( ExpectCongestionWindow { 11 * mss } );
+      expect_segments( test, 2 );
+      test.execute( ExpectSeqnosInFlight { 11 * mss } );
+      // a stretch ACK for four segments only counts for two (RFC 3465)
+      test.execute( ack( a + 5 * mss ) );
+      test.execute( ExpectCongestionWindow { 13 * mss } );
+      expect_segments( test, 6 );
+      test.execute( ExpectSeqnosInFlight { 13 * mss } );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPSenderTestHarness test { "An application-limited sender does not grow the window",
+                                  sender_config( isn, 2 * WINDOW ),
+                                  FromConfig {} };
+      connect( test, isn );
+      const Wrap32 a = isn + 1;
+      // three segments do not show that ten would have made it (RFC 7661)
+      test.execute( Push { string( 3 * mss, 'x' ) } );
+      expect_segments( test, 3 );
+      test.execute( Tick { 10 } );
+      test.execute( ack( a + 3 * mss ) );
+      test.execute( ExpectCongestionWindow { 10 * mss } );
+      // a full window does
+      test.execute( Push { string( 10 * mss, 'x' ) } );
+      expect_segments( test, 10 );
+      test.execute( Tick { 10 } );
+      test.execute( ack( a + 13 * mss ) );
+      test.execute( ExpectCongestionWindow { 12 * mss } );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPSenderTestHarness test { "Fast retransmit halves the window, then each window acked adds one MSS",
+                                  sender_config( isn, 2 * WINDOW ),
+                                  FromConfig {} };
+      connect( test, isn );
+      const Wrap32 a = isn + 1;
+      test.execute( Push { string( 10 * mss, 'x' ) } );
+      expect_segments( test, 10 );
+      test.execute( Tick { 10 } );
+      for ( int i = 0; i < 3; i++ ) {
+        test.execute( ack( a ) );
+      }
+      test.execute( ExpectInRecovery { true } );
+      test.execute( ExpectSlowStartThreshold { 5 * mss } );
+      test.execute( ExpectCongestionWindow { 5 * mss } );
+      test.execute( ExpectMessage {}.with_payload_size( mss ).with_seqno( a ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 10 } );
+      test.execute( ack( a + 10 * mss ) );
+      test.execute( ExpectInRecovery { false } );
+      test.execute( ExpectCongestionWindow { 5 * mss } );
+
+      test.execute( Push { string( 30 * mss, 'x' ) } );
+      expect_segments( test, 5 );
+      test.execute( Tick { 10 } );
+      test.execute( ack( a + 13 * mss ) );
+      test.execute( ExpectCongestionWindow { 5 * mss } );
+      test.execute( ack( a + 15 * mss ) );
+      test.execute( ExpectCongestionWindow { 6 * mss } );
+      test.execute( ExpectSlowStartThreshold { 5 * mss } );
+      expect_segments( test, 6 );
+      test.execute( Tick { 10 } );
+      test.execute( ack( a + 21 * mss ) );
+      test.execute( ExpectCongestionWindow { 7 * mss } );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPSenderTestHarness test { "Congestion avoidance counts the bytes acked, not the ACKs",
+                                  sender_config( isn, 2 * WINDOW ),
+                                  FromConfig {} };
+      connect( test, isn );
+      const Wrap32 a = isn + 1;
+      test.execute( Push { string( 10 * mss, 'x' ) } );
+      expect_segments( test, 10 );
+      test.execute( Tick { 10 } );
+      for ( int i = 0; i < 3; i++ ) {
+        test.execute( ack( a ) );
+      }
+      test.execute( ExpectMessage {}.with_payload_size( mss ).with_seqno( a ) );
+      test.execute( Tick { 10 } );
+      test.execute( ack( a + 10 * mss ) );
+      test.execute( ExpectCongestionWindow { 5 * mss } );
+
+      // one ACK for the whole window adds one MSS...
+      test.execute( Push { string( 30 * mss, 'x' ) } );
+      expect_segments( test, 5 );
+      test.execute( Tick { 10 } );
+      test.execute( ack( a + 15 * mss ) );
+      test.execute( ExpectCongestionWindow { 6 * mss } );
+      expect_segments( test, 6 );
+
+      // ...and so do six ACKs of one segment each, but only once the sixth arrives
+      test.execute( Tick { 10 } );
+      for ( uint64_t i = 1; i < 6; i++ ) {
+        test.execute( ack( a + ( 15 + i ) * mss ) );
+        test.execute( ExpectCongestionWindow { 6 * mss } );
+      }
+      test.execute( ack( a + 21 * mss ) );
+      test.execute( ExpectCongestionWindow { 7 * mss } );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPSenderTestHarness test {
+        "A timeout collapses the window to one segment", sender_config( isn, 2 * WINDOW ), FromConfig {} };
+      connect( test, isn );
+      const Wrap32 a = isn + 1;
+      test.execute( Push { string( 10 * mss, 'x' ) } );
+      expect_segments( test, 10 );
+      // the tail loss probe goes first, and does not touch the window
+      test.execute( Tick { 20 } );
+      test.execute( ExpectMessage {}.with_payload_size( mss ).with_seqno( a + 9 * mss ) );
+      test.execute( ExpectCongestionWindow { 10 * mss } );
+      test.execute( Tick { 200 } );
+      test.execute( ExpectMessage {}.with_payload_size( mss ).with_seqno( a ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectCongestionWindow { mss } );
+      test.execute( ExpectSlowStartThreshold { 5 * mss } );
+      // slow start again from one segment
+      test.execute( Tick { 10 } );
+      test.execute( ack( a + mss ) );
+      test.execute( ExpectCongestionWindow { 2 * mss } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,211 @@
+#include "congestion_controller.hh"
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <utility>
+
+using namespace std;
+
+namespace {
+
+void expect_full_segments( TCPSenderTestHarness& test, uint64_t count )
+{
+  for ( uint64_t i = 0; i < count; i++ ) {
+    test.execute( ExpectMessage {}.with_payload_size( TCPConfig::MAX_PAYLOAD_SIZE ).with_cwr( false ) );
+  }
+  test.execute( ExpectNoSegment {} );
+}
+
+class DCTCPTestHarness : public TestHarness<DCTCP>
+{
+public:
+  DCTCPTestHarness( string test_name, uint64_t mss )
+    : TestHarness( move( test_name ), "mss=" + to_string( mss ), DCTCP { mss } )
+  {}
+};
+
+struct AckArrives : public Action<DCTCP>
+{
+  uint64_t bytes_;
+  bool ece_;
+  AckArrives( uint64_t bytes, bool ece ) : bytes_( bytes ), ece_( ece ) {}
+  string description() const override
+  {
+    return "ACK of " + to_string( bytes_ ) + " bytes" + ( ece_ ? " with ECE" : "" );
+  }
+  void execute( DCTCP& dctcp ) const override
+  {
+    dctcp.on_ack( { .acked_bytes = bytes_, .prior_in_flight = dctcp.cwnd(), .ece = ece_ } );
+  }
+};
+
+// one unmarked ACK for a whole window
+struct AckWindow : public Action<DCTCP>
+{
+  string description() const override { return "ACK of a whole window"; }
+  void execute( DCTCP& dctcp ) const override
+  {
+    dctcp.on_ack( { .acked_bytes = dctcp.cwnd(), .prior_in_flight = dctcp.cwnd() } );
+  }
+};
+
+struct ReduceForECN : public Action<DCTCP>
+{
+  string description() const override { return "reduce the window for ECE"; }
+  void execute( DCTCP& dctcp ) const override { dctcp.on_ecn( dctcp.cwnd() ); }
+};
+
+struct ExpectDCTCPWindow : public ExpectNumber<DCTCP, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  string name() const override { return "cwnd"; }
+  uint64_t value( DCTCP& dctcp ) const override { return dctcp.cwnd(); }
+};
+
+struct ExpectAlpha : public ExpectNumber<DCTCP, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  string name() const override { return "alpha"; }
+  uint64_t value( DCTCP& dctcp ) const override { return dctcp.alpha(); }
+};
+
+} // namespace
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+    const uint64_t mss = TCPConfig::MAX_PAYLOAD_SIZE;
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = sender_config( isn, 2 * WINDOW );
+      cfg.ecn = true;
+      TCPSenderTestHarness test { "Data is ECN-capable once both SYNs requested it", cfg, FromConfig {} };
+      connect( test, isn );
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ).with_ect( true ).with_ecn( false ).with_cwr( false ) );
+      // a retransmission is ECN-capable too
+      test.execute( Tick { 1000 } );
+      test.execute( ExpectMessage {}.with_data( "abc" ).with_ect( true ) );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = sender_config( isn, 2 * WINDOW );
+      TCPSenderTestHarness test { "No ECN unless configured", cfg, FromConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_ecn( false ) );
+      test.execute( SetPeerECN { true } );
+      test.execute( Tick { 10 } );
+      test.execute( ack( isn + 1 ) );
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ).with_ect( false ) );
+      test.execute( Tick { 10 } );
+      test.execute( ack( isn + 4 ).with_ece() );
+      test.execute( ExpectECNReductions { 0 } );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = sender_config( isn, 2 * WINDOW );
+      cfg.ecn = true;
+      TCPSenderTestHarness test { "No ECN when the peer's SYN did not request it", cfg, FromConfig {} };
+      connect( test, isn );
+      test.execute( SetPeerECN { false } );
+      test.execute( ExpectCongestionWindow { 10 * mss } );
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ).with_ect( false ) );
+      test.execute( Tick { 10 } );
+      test.execute( ack( isn + 4 ).with_ece() );
+      test.execute( ExpectECNReductions { 0 } );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = sender_config( isn, 2 * WINDOW );
+      cfg.ecn = true;
+      TCPSenderTestHarness test {
+        "ECE halves the window once per window and is answered with CWR", cfg, FromConfig {} };
+      connect( test, isn );
+      const Wrap32 a = isn + 1;
+      test.execute( Push { string( 30 * mss, 'x' ) } );
+      expect_full_segments( test, 10 );
+      test.execute( Tick { 10 } );
+      test.execute( ack( a + 4 * mss ).with_ece() );
+      // half the flight, as for a loss, but nothing is retransmitted
+      test.execute( ExpectCongestionWindow { 5 * mss } );
+      test.execute( ExpectECNReductions { 1 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectInRecovery { false } );
+      // more ECE for data sent before the reduction does not reduce again
+      test.execute( ack( a + 10 * mss ).with_ece() );
+      test.execute( ExpectECNReductions { 1 } );
+      test.execute( ExpectCongestionWindow { 6 * mss } );
+      // the first new segment tells the receiver to stop echoing
+      test.execute( ExpectMessage {}.with_payload_size( mss ).with_cwr( true ).with_ect( true ) );
+      expect_full_segments( test, 5 );
+      test.execute( Tick { 10 } );
+      test.execute( ack( a + 16 * mss ) );
+      test.execute( ExpectCongestionWindow { 7 * mss } );
+      expect_full_segments( test, 7 );
+      // a mark on data sent after the reduction is a new congestion event
+      test.execute( Tick { 10 } );
+      test.execute( ack( a + 23 * mss ).with_ece() );
+      test.execute( ExpectECNReductions { 2 } );
+      test.execute( ExpectMessage {}.with_payload_size( mss ).with_cwr( true ) );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = sender_config( isn, 2 * WINDOW );
+      cfg.congestion_control = TCPConfig::CongestionControl::DCTCP;
+      TCPSenderTestHarness test { "DCTCP requests ECN on its own", cfg, FromConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_ecn( true ) );
+    }
+
+    {
+      DCTCPTestHarness test { "DCTCP's first reduction halves the window", mss };
+      test.execute( ExpectAlpha { DCTCP::ALPHA_ONE } );
+      test.execute( ReduceForECN {} );
+      test.execute( ExpectDCTCPWindow { 5 * mss } );
+    }
+
+    {
+      DCTCPTestHarness test { "DCTCP's alpha follows the marked fraction of each window", mss };
+      test.execute( AckArrives { 10 * mss, false } );
+      test.execute( ExpectAlpha { 960 } );
+      test.execute( ExpectDCTCPWindow { 12 * mss } );
+      // half of the next window was marked
+      test.execute( AckArrives { 6 * mss, true } );
+      test.execute( ExpectAlpha { 960 } );
+      test.execute( AckArrives { 6 * mss, false } );
+      test.execute( ExpectAlpha { 932 } );
+      // cwnd * (1 - alpha / 2)
+      test.execute( ReduceForECN {} );
+      test.execute( ExpectDCTCPWindow { 8719 } );
+    }
+
+    {
+      DCTCPTestHarness test { "Light marking takes a small bite out of the window", mss };
+      for ( int i = 0; i < 30; i++ ) {
+        test.execute( AckWindow {} );
+      }
+      test.execute( ExpectAlpha { 155 } );
+      test.execute( ExpectDCTCPWindow { 70 * mss } );
+      test.execute( ReduceForECN {} );
+      test.execute( ExpectDCTCPWindow { 64703 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
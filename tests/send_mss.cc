@@ -0,0 +1,160 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = sender_config( isn, 2 * WINDOW );
+      cfg.mss = 1460;
+      cfg.nodelay = true; // let the tail of each write out at once, whatever is in flight
+      TCPSenderTestHarness test { "SYN announces the configured MSS", cfg, FromConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_mss( 1460 ) );
+      test.execute( SetPeerMSS { 1460 } );
+      test.execute( ack( isn + 1 ) );
+      test.execute( ExpectMSS { 1460 } );
+      test.execute( Push { string( 3000, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 1460 ).with_mss( 0 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1460 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 80 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = sender_config( isn, 2 * WINDOW );
+      cfg.mss = 1460;
+      cfg.nodelay = true;
+      TCPSenderTestHarness test { "Peer's MSS caps the segment size", cfg, FromConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( SetPeerMSS { 536 } );
+      test.execute( ack( isn + 1 ) );
+      test.execute( ExpectMSS { 536 } );
+      test.execute( ExpectCongestionWindow { 10 * 536 } );
+      test.execute( Push { string( 1200, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 536 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 536 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 128 ) );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = sender_config( isn, 2 * WINDOW );
+      cfg.mss = 1460;
+      cfg.nodelay = true;
+      TCPSenderTestHarness test { "No MSS option means 536", cfg, FromConfig {} };
+      test.execute( SetPeerMSS { 0 } );
+      test.execute( ExpectMSS { TCPConfig::DEFAULT_PEER_MSS } );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = sender_config( isn, 2 * WINDOW );
+      cfg.mss = 4000;
+      cfg.mtu_probing = true;
+      cfg.nodelay = true;
+      TCPSenderTestHarness test { "MTU probe succeeds", cfg, FromConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_mss( 4000 ) );
+      test.execute( ack( isn + 1 ) );
+      test.execute( ExpectMSS { 1000 } );
+
+      // the first segment probes halfway between the working size and the ceiling
+      test.execute( Push { string( 6500, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 2500 ) );
+      for ( int i = 0; i < 4; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( 1000 ) );
+      }
+      test.execute( ExpectNoSegment {} );
+      test.execute( ack( isn + 1 + 6500 ) );
+      test.execute( ExpectMSS { 2500 } );
+
+      // then the next size up
+      test.execute( Push { string( 5750, 'y' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 3250 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 2500 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = sender_config( isn, 2 * WINDOW );
+      cfg.mss = 4000;
+      cfg.mtu_probing = true;
+      cfg.nodelay = true;
+      TCPSenderTestHarness test { "Lost MTU probe is resent at the old size", cfg, FromConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( ack( isn + 1 ) );
+      test.execute( Push { string( 2500, 'a' ) + string( 3000, 'b' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 2500 ) );
+      for ( int i = 0; i < 3; ++i ) {
+        test.execute( ExpectMessage {}.with_data( string( 1000, 'b' ) ) );
+      }
+
+      // three duplicate ACKs: the probe did not fit, which is not congestion
+      for ( int i = 0; i < 3; ++i ) {
+        test.execute( ack( isn + 1 ) );
+      }
+      test.execute( ExpectMessage {}.with_data( string( 1000, 'a' ) ).with_seqno( isn + 1 ) );
+      test.execute( ExpectMessage {}.with_data( string( 1000, 'a' ) ).with_seqno( isn + 1001 ) );
+      test.execute( ExpectMessage {}.with_data( string( 500, 'a' ) ).with_seqno( isn + 2001 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectInRecovery { false } );
+      test.execute( ExpectCongestionWindow { 10000 } );
+      test.execute( ExpectMSS { 1000 } );
+
+      // a fourth duplicate ACK from the same flight changes nothing
+      test.execute( ack( isn + 1 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ack( isn + 1 + 5500 ) );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+      test.execute( ExpectConsecutiveRetransmissions { 0 } );
+
+      // the next probe searches below the size that was lost
+      test.execute( Push { string( 1750, 'c' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 1750 ) );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = sender_config( isn, 2 * WINDOW );
+      cfg.mss = 4000;
+      cfg.mtu_probing = true;
+      cfg.nodelay = true;
+      TCPSenderTestHarness test { "MTU probe times out", cfg, FromConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( ack( isn + 1 ) );
+      test.execute( Push { string( 2500, 'a' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 2500 ) );
+      test.execute( Tick { 199 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 500 ) );
+      test.execute( ExpectCongestionWindow { 10000 } );
+      test.execute( ExpectRTO { 200 } );
+      test.execute( ExpectConsecutiveRetransmissions { 0 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,106 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+    const uint64_t mss = TCPConfig::MAX_PAYLOAD_SIZE;
+
+    {
+      const Wrap32 isn( rd() );
+      TCPSenderTestHarness test {
+        "Nagle coalesces small writes while data is in flight", sender_config( isn, 2 * WINDOW ), FromConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( ack( isn + 1 ) );
+      test.execute( Push { "a" } );
+      test.execute( ExpectMessage {}.with_data( "a" ) );
+      test.execute( Push { "b" } );
+      test.execute( Push { "c" } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ack( isn + 2 ) );
+      test.execute( ExpectMessage {}.with_data( "bc" ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = sender_config( isn, 2 * WINDOW );
+      cfg.nodelay = true;
+      TCPSenderTestHarness test { "Nodelay sends every write at once", cfg, FromConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( ack( isn + 1 ) );
+      test.execute( Push { "a" } );
+      test.execute( ExpectMessage {}.with_data( "a" ) );
+      test.execute( Push { "b" } );
+      test.execute( ExpectMessage {}.with_data( "b" ) );
+      test.execute( Push { "c" } );
+      test.execute( ExpectMessage {}.with_data( "c" ) );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPSenderTestHarness test {
+        "Nagle sends full segments and a closing tail", sender_config( isn, 2 * WINDOW ), FromConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( ack( isn + 1 ) );
+      test.execute( Push { string( 2 * mss + 10, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( mss ) );
+      test.execute( ExpectMessage {}.with_payload_size( mss ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Close {} );
+      test.execute( ExpectMessage {}.with_payload_size( 10 ).with_fin( true ) );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = sender_config( isn, 2 * WINDOW );
+      cfg.nodelay = true;
+      TCPSenderTestHarness test { "A cork holds partial segments until the autocork timeout", cfg, FromConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( ack( isn + 1 ) );
+      test.execute( SetCorked { true } );
+      test.execute( Push { "abc" } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { TCPConfig::AUTOCORK_DFLT - 1 } );
+      test.execute( Push { "def" } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_data( "abcdef" ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPSenderTestHarness test {
+        "Uncork flushes the partial segment, even under Nagle", sender_config( isn, 2 * WINDOW ), FromConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( ack( isn + 1 ) );
+      test.execute( SetCorked { true } );
+      test.execute( Push { string( mss + 5, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( mss ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( SetCorked { false } );
+      test.execute( ExpectMessage {}.with_payload_size( 5 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,145 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      const Wrap32 isn( rd() );
+      // 100 kB/s: one full segment every 10 ms
+      TCPConfig cfg = sender_config( isn, 2 * WINDOW );
+      cfg.pacing = true;
+      cfg.pacing_rate = 100'000;
+      TCPSenderTestHarness test { "Fixed pacing rate", cfg, FromConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( Tick { 10 } );
+      test.execute( ack( isn + 1 ) );
+      test.execute( ExpectPacingRate { 100'000 } );
+
+      // the 10 ms handshake refilled the bucket to two segments' worth of tokens; then one segment per 10 ms
+      test.execute( Push { segment( 'a' ) + segment( 'b' ) + segment( 'c' ) + segment( 'd' ) + segment( 'e' ) } );
+      test.execute( ExpectMessage {}.with_data( segment( 'a' ) ) );
+      test.execute( ExpectMessage {}.with_data( segment( 'b' ) ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 9 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_data( segment( 'c' ) ) );
+      test.execute( Tick { 10 } );
+      test.execute( ExpectMessage {}.with_data( segment( 'd' ) ) );
+      test.execute( Tick { 10 } );
+      test.execute( ExpectMessage {}.with_data( segment( 'e' ) ) );
+      test.execute( ExpectNoSegment {} );
+
+      // an idle sender saves up at most one bucket
+      test.execute( ack( isn + 1 + 5 * TCPConfig::MAX_PAYLOAD_SIZE ) );
+      test.execute( Tick { 1000 } );
+      test.execute( Push { segment( 'f' ) + segment( 'g' ) + segment( 'h' ) } );
+      test.execute( ExpectMessage {}.with_data( segment( 'f' ) ) );
+      test.execute( ExpectMessage {}.with_data( segment( 'g' ) ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 10 } );
+      test.execute( ExpectMessage {}.with_data( segment( 'h' ) ) );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = sender_config( isn, 2 * WINDOW );
+      cfg.pacing = true;
+      cfg.pacing_rate = 100'000;
+      TCPSenderTestHarness test { "Running out of data does not count as waiting for tokens", cfg, FromConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( Tick { 10 } );
+      test.execute( ack( isn + 1 ) );
+
+      // the two segments empty the bucket exactly as the stream runs dry
+      test.execute( Push { segment( 'a' ) + segment( 'b' ) } );
+      test.execute( ExpectMessage {}.with_data( segment( 'a' ) ) );
+      test.execute( ExpectMessage {}.with_data( segment( 'b' ) ) );
+      test.execute( ack( isn + 1 + 2 * TCPConfig::MAX_PAYLOAD_SIZE ) );
+
+      // so the idle second still saves up only one bucket
+      test.execute( Tick { 1000 } );
+      test.execute( Push { segment( 'c' ) + segment( 'd' ) + segment( 'e' ) } );
+      test.execute( ExpectMessage {}.with_data( segment( 'c' ) ) );
+      test.execute( ExpectMessage {}.with_data( segment( 'd' ) ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 10 } );
+      test.execute( ExpectMessage {}.with_data( segment( 'e' ) ) );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = sender_config( isn, 2 * WINDOW );
+      cfg.pacing = true;
+      cfg.pacing_rate = 0;
+      TCPSenderTestHarness test { "Pacing rate follows cwnd/SRTT", cfg, FromConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( ExpectPacingRate { 0 } );
+      test.execute( Tick { 100 } );
+      test.execute( ack( isn + 1 ) );
+
+      // slow start: twice a 10-segment window per 100 ms
+      test.execute( ExpectCongestionWindow { 10 * TCPConfig::MAX_PAYLOAD_SIZE } );
+      test.execute( ExpectPacingRate { 200'000 } );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = sender_config( isn, 2 * WINDOW );
+      cfg.pacing = true;
+      cfg.pacing_rate = 100'000;
+      cfg.mss = 4000;
+      cfg.mtu_probing = true;
+      cfg.nodelay = true;
+      TCPSenderTestHarness test { "The bucket grows with the MSS", cfg, FromConfig {} };
+      connect( test, isn );
+
+      // the 2500-byte probe is bigger than the two-segment bucket, so it waits for 500 more bytes of tokens
+      test.execute( Push { string( 2500, 'x' ) } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 5 } );
+      test.execute( ExpectMessage {}.with_payload_size( 2500 ) );
+      test.execute( Tick { 10 } );
+      test.execute( ack( isn + 1 + 2500 ) );
+      test.execute( ExpectMSS { 2500 } );
+
+      // once the probe gets through, an idle bucket holds two of the bigger segments
+      test.execute( Tick { 1000 } );
+      test.execute( Push { string( 2500, 'y' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 2500 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPSenderTestHarness test { "No pacing unless configured", sender_config( isn, 2 * WINDOW ), FromConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( ack( isn + 1 ) );
+      test.execute( ExpectPacingRate { 0 } );
+      test.execute( Push { segment( 'a' ) + segment( 'b' ) + segment( 'c' ) } );
+      test.execute( ExpectMessage {}.with_data( segment( 'a' ) ) );
+      test.execute( ExpectMessage {}.with_data( segment( 'b' ) ) );
+      test.execute( ExpectMessage {}.with_data( segment( 'c' ) ) );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
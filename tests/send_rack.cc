@@ -0,0 +1,225 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+    const uint64_t mss = TCPConfig::MAX_PAYLOAD_SIZE;
+
+    {
+      const Wrap32 isn( rd() );
+      TCPSenderTestHarness test {
+        "One SACK past the reordering window marks a loss", sender_config( isn, 2 * WINDOW ), FromConfig {} };
+      connect( test, isn );
+      test.execute( ExpectRTO { 200 } );
+      const Wrap32 a = isn + 1;
+      const Wrap32 c = a + 2 * mss;
+      test.execute( Push { segment( 'a' ) + segment( 'b' ) + segment( 'c' ) } );
+      test.execute( ExpectMessage {}.with_data( segment( 'a' ) ) );
+      test.execute( ExpectMessage {}.with_data( segment( 'b' ) ) );
+      test.execute( ExpectMessage {}.with_data( segment( 'c' ) ) );
+      // c arrives a round trip later; a and b get another quarter of the min RTT, rounded up to 3 ms,
+      // before they count as lost
+      test.execute( Tick { 10 } );
+      test.execute( ack( a ).with_sack( c, c + mss ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectInRecovery { false } );
+      test.execute( Tick { 2 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectInRecovery { true } );
+      test.execute( ExpectRackLosses { 2 } );
+      test.execute( ExpectMessage {}.with_data( segment( 'a' ) ) );
+      test.execute( ExpectNoSegment {} );
+      // the partial ACK lets PRR send the other marked segment
+      test.execute( Tick { 10 } );
+      test.execute( ack( a + mss ).with_sack( c, c + mss ) );
+      test.execute( ExpectMessage {}.with_data( segment( 'b' ) ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ack( c + mss ) );
+      test.execute( ExpectInRecovery { false } );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPSenderTestHarness test {
+        "One reordered segment is not a loss on a 2 ms path", sender_config( isn, 2 * WINDOW ), FromConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( Tick { 2 } );
+      test.execute( ack( isn + 1 ) );
+      const Wrap32 a = isn + 1;
+      const Wrap32 c = a + 2 * mss;
+      test.execute( Push { segment( 'a' ) + segment( 'b' ) + segment( 'c' ) } );
+      test.execute( ExpectMessage {}.with_data( segment( 'a' ) ) );
+      test.execute( ExpectMessage {}.with_data( segment( 'b' ) ) );
+      test.execute( ExpectMessage {}.with_data( segment( 'c' ) ) );
+      // a quarter of 2 ms still leaves b one tick to arrive after c
+      test.execute( Tick { 2 } );
+      test.execute( ack( a + mss ).with_sack( c, c + mss ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectRackLosses { 0 } );
+      test.execute( ack( c + mss ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectInRecovery { false } );
+      test.execute( ExpectRackLosses { 0 } );
+      test.execute( ExpectCongestionWindow { 10 * mss } );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPSenderTestHarness test {
+        "Segments sent after the SACKed one are not judged", sender_config( isn, 2 * WINDOW ), FromConfig {} };
+      connect( test, isn );
+      const Wrap32 a = isn + 1;
+      test.execute( Push { segment( 'a' ) + segment( 'b' ) } );
+      test.execute( ExpectMessage {}.with_data( segment( 'a' ) ) );
+      test.execute( ExpectMessage {}.with_data( segment( 'b' ) ) );
+      test.execute( Tick { 10 } );
+      test.execute( ack( a ).with_sack( a, a + mss ) );
+      test.execute( Tick { 15 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectRackLosses { 0 } );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPSenderTestHarness test { "A tail loss probe resends the last segment well before the RTO",
+                                  sender_config( isn, 2 * WINDOW ),
+                                  FromConfig {} };
+      connect( test, isn );
+      const Wrap32 a = isn + 1;
+      const Wrap32 b = a + mss;
+      test.execute( Push { segment( 'a' ) + segment( 'b' ) } );
+      test.execute( ExpectMessage {}.with_data( segment( 'a' ) ) );
+      test.execute( ExpectMessage {}.with_data( segment( 'b' ) ) );
+      // PTO = 2 * SRTT
+      test.execute( Tick { 19 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_data( segment( 'b' ) ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectTailLossProbes { 1 } );
+      test.execute( ExpectConsecutiveRetransmissions { 0 } );
+      // the probe's SACK exposes the lost head to RACK, which repairs it without a timeout
+      test.execute( Tick { 10 } );
+      test.execute( ack( a ).with_sack( b, b + mss ) );
+      test.execute( ExpectInRecovery { true } );
+      test.execute( ExpectMessage {}.with_data( segment( 'a' ) ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ack( b + mss ) );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+      test.execute( Tick { 1000 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectTailLossProbes { 1 } );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPSenderTestHarness test {
+        "A tail loss probe prefers new data", sender_config( isn, 2 * WINDOW ), FromConfig {} };
+      connect( test, isn );
+      test.execute( ExpectCongestionWindow { 10 * mss } );
+      string data;
+      for ( char c = 'a'; c <= 'k'; c++ ) {
+        data += segment( c );
+      }
+      test.execute( Push { data } );
+      for ( char c = 'a'; c <= 'j'; c++ ) {
+        test.execute( ExpectMessage {}.with_data( segment( c ) ) );
+      }
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 20 } );
+      test.execute( ExpectMessage {}.with_data( segment( 'k' ) ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectTailLossProbes { 1 } );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPSenderTestHarness test {
+        "A probe that repaired a loss reduces the window", sender_config( isn, 2 * WINDOW ), FromConfig {} };
+      connect( test, isn );
+      const Wrap32 a = isn + 1;
+      test.execute( Push { segment( 'a' ) + segment( 'b' ) } );
+      test.execute( ExpectMessage {}.with_data( segment( 'a' ) ) );
+      test.execute( ExpectMessage {}.with_data( segment( 'b' ) ) );
+      test.execute( Tick { 20 } );
+      test.execute( ExpectMessage {}.with_data( segment( 'b' ) ) );
+      test.execute( Tick { 10 } );
+      test.execute( ack( a + 2 * mss ) );
+      test.execute( ExpectCongestionWindow { 2 * mss } );
+      test.execute( ExpectInRecovery { false } );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPSenderTestHarness test { "No window reduction when the echo shows the original arrived",
+                                  sender_config( isn, 2 * WINDOW ),
+                                  FromConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_timestamp( 0 ) );
+      test.execute( SetPeerTimestamps { true } );
+      test.execute( Tick { 10 } );
+      test.execute( ack( isn + 1 ).with_timestamp_echo( 0 ) );
+      const uint64_t ts_mss = mss - TCPConfig::TIMESTAMPS_LEN;
+      const uint64_t cwnd = 10 * ts_mss;
+      test.execute( ExpectCongestionWindow { cwnd } );
+      test.execute( Push { string( 2 * ts_mss, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( ts_mss ).with_timestamp( 10 ) );
+      test.execute( ExpectMessage {}.with_payload_size( ts_mss ).with_timestamp( 10 ) );
+      test.execute( Tick { 20 } );
+      test.execute( ExpectMessage {}.with_payload_size( ts_mss ).with_timestamp( 30 ) );
+      test.execute( Tick { 5 } );
+      test.execute( ack( isn + 1 + 2 * ts_mss ).with_timestamp_echo( 10 ) );
+      test.execute( ExpectCongestionWindow { cwnd } );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPSenderTestHarness test {
+        "No probe for a lone segment that the RTO covers first", sender_config( isn, 2 * WINDOW ), FromConfig {} };
+      connect( test, isn );
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ) );
+      // PTO = 2 * SRTT plus a delayed ACK = 220 ms, later than the 200 ms RTO
+      test.execute( Tick { 199 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_data( "abc" ) );
+      test.execute( ExpectConsecutiveRetransmissions { 1 } );
+      test.execute( ExpectTailLossProbes { 0 } );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = sender_config( isn, 2 * WINDOW );
+      cfg.rack = false;
+      TCPSenderTestHarness test { "No tail loss probe when RACK-TLP is disabled", cfg, FromConfig {} };
+      connect( test, isn );
+      test.execute( Push { segment( 'a' ) + segment( 'b' ) } );
+      test.execute( ExpectMessage {}.with_data( segment( 'a' ) ) );
+      test.execute( ExpectMessage {}.with_data( segment( 'b' ) ) );
+      test.execute( Tick { 199 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_data( segment( 'a' ) ) );
+      test.execute( ExpectTailLossProbes { 0 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,89 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+namespace {
+
+void expect_full_segments( TCPSenderTestHarness& test, uint64_t count )
+{
+  for ( uint64_t i = 0; i < count; i++ ) {
+    test.execute( ExpectMessage {}.with_payload_size( TCPConfig::MAX_PAYLOAD_SIZE ) );
+  }
+  test.execute( ExpectNoSegment {} );
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+    const uint64_t mss = TCPConfig::MAX_PAYLOAD_SIZE;
+
+    {
+      const Wrap32 isn( rd() );
+      TCPSenderTestHarness test { "The first flight after idle is app-limited, the next is not",
+                                  sender_config( isn, 2 * WINDOW ),
+                                  FromConfig {} };
+      connect( test, isn );
+      const Wrap32 a = isn + 1;
+      test.execute( Push { string( 30 * mss, 'x' ) } );
+      expect_full_segments( test, 10 );
+      // the sender had nothing to send when the handshake finished
+      test.execute( Tick { 10 } );
+      test.execute( ack( a + 10 * mss ) );
+      test.execute( ExpectDeliveryRate { 1000000 } );
+      test.execute( ExpectRateAppLimited { true } );
+      // slow start grew the window by two segments; all of it went out at once
+      expect_full_segments( test, 12 );
+      test.execute( Tick { 10 } );
+      test.execute( ack( a + 22 * mss ) );
+      test.execute( ExpectDeliveryRate { 1200000 } );
+      test.execute( ExpectRateAppLimited { false } );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPSenderTestHarness test {
+        "A small write gives an app-limited sample", sender_config( isn, 2 * WINDOW ), FromConfig {} };
+      connect( test, isn );
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ) );
+      test.execute( Tick { 10 } );
+      test.execute( ack( isn + 4 ) );
+      test.execute( ExpectDeliveryRate { 300 } );
+      test.execute( ExpectRateAppLimited { true } );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = sender_config( isn, 2 * WINDOW );
+      cfg.rack = false; // keep a and b outstanding rather than retransmitted by RACK
+      TCPSenderTestHarness test { "A SACKed segment counts as delivered", cfg, FromConfig {} };
+      connect( test, isn );
+      const Wrap32 a = isn + 1;
+      const Wrap32 c = a + 2 * mss;
+      test.execute( Push { string( 3 * mss, 'x' ) } );
+      expect_full_segments( test, 3 );
+      test.execute( Tick { 10 } );
+      test.execute( ack( a ).with_sack( c, c + mss ) );
+      test.execute( ExpectDeliveryRate { 100000 } );
+      // the cumulative ACK does not count the SACKed bytes again
+      test.execute( Tick { 10 } );
+      test.execute( ack( a + 3 * mss ) );
+      test.execute( ExpectDeliveryRate { 150000 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,154 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+    const uint64_t mss = TCPConfig::MAX_PAYLOAD_SIZE;
+
+    {
+      const Wrap32 isn( rd() );
+      TCPSenderTestHarness test {
+        "Limited transmit, fast retransmit, then PRR", sender_config( isn, 2 * WINDOW ), FromConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( ack( isn + 1 ) );
+      test.execute( ExpectCongestionWindow { 10 * mss } );
+
+      string data;
+      for ( char c = 'a'; c < 'a' + 12; ++c ) {
+        data += segment( c );
+      }
+      test.execute( Push { data } );
+      for ( char c = 'a'; c < 'a' + 10; ++c ) {
+        test.execute( ExpectMessage {}.with_data( segment( c ) ) );
+      }
+      test.execute( ExpectNoSegment {} );
+
+      // "a" was lost; the first two duplicate ACKs each let one new segment out past cwnd (RFC 3042)
+      test.execute( ack( isn + 1 ) );
+      test.execute( ExpectMessage {}.with_data( segment( 'k' ) ).with_seqno( isn + 1 + 10 * mss ) );
+      test.execute( ack( isn + 1 ) );
+      test.execute( ExpectMessage {}.with_data( segment( 'l' ) ) );
+      test.execute( ExpectInRecovery { false } );
+      test.execute( ExpectCongestionWindow { 10 * mss } );
+
+      // the third one retransmits "a" right away and halves the window
+      test.execute( ack( isn + 1 ) );
+      test.execute( ExpectMessage {}.with_data( segment( 'a' ) ).with_seqno( isn + 1 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectInRecovery { true } );
+      test.execute( ExpectCongestionWindow { 6 * mss } );
+      test.execute( ExpectSeqnosInFlight { 12 * mss } );
+
+      // PRR: nothing new goes out while the flight drains toward ssthresh, then one segment per segment delivered
+      test.execute( Push { segment( 'm' ) + segment( 'n' ) + segment( 'o' ) } );
+      test.execute( ExpectNoSegment {} );
+      for ( int i = 0; i < 3; ++i ) {
+        test.execute( ack( isn + 1 ) );
+        test.execute( ExpectNoSegment {} );
+      }
+      test.execute( ack( isn + 1 ) );
+      test.execute( ExpectMessage {}.with_data( segment( 'm' ) ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ack( isn + 1 ) );
+      test.execute( ExpectMessage {}.with_data( segment( 'n' ) ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectConsecutiveRetransmissions { 0 } );
+
+      // the retransmission arrives: everything sent before recovery is acknowledged, recovery ends
+      test.execute( ack( isn + 1 + 12 * mss ) );
+      test.execute( ExpectInRecovery { false } );
+      test.execute( ExpectCongestionWindow { 6 * mss } );
+      test.execute( ExpectMessage {}.with_data( segment( 'o' ) ) );
+      test.execute( ExpectSeqnosInFlight { 3 * mss } );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPSenderTestHarness test {
+        "Partial ACK retransmits the next hole", sender_config( isn, 2 * WINDOW ), FromConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( ack( isn + 1 ) );
+      test.execute( Push { segment( 'a' ) + segment( 'b' ) + segment( 'c' ) + segment( 'd' ) + segment( 'e' )
+                           + segment( 'f' ) } );
+      for ( char c = 'a'; c < 'a' + 6; ++c ) {
+        test.execute( ExpectMessage {}.with_data( segment( c ) ) );
+      }
+
+      // "a" and "c" were lost
+      test.execute( ack( isn + 1 ) );
+      test.execute( ack( isn + 1 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ack( isn + 1 ) );
+      test.execute( ExpectMessage {}.with_data( segment( 'a' ) ).with_seqno( isn + 1 ) );
+      test.execute( ack( isn + 1 ) );
+      test.execute( ExpectNoSegment {} );
+
+      test.execute( ack( isn + 1 + 2 * mss ) );
+      test.execute( ExpectInRecovery { true } );
+      test.execute( ExpectMessage {}.with_data( segment( 'c' ) ).with_seqno( isn + 1 + 2 * mss ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ack( isn + 1 + 6 * mss ) );
+      test.execute( ExpectInRecovery { false } );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPSenderTestHarness test {
+        "Duplicate ACKs that change the window are not counted", sender_config( isn, 2 * WINDOW ), FromConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( ack( isn + 1 ) );
+      test.execute( Push { segment( 'a' ) + segment( 'b' ) + segment( 'c' ) + segment( 'd' ) } );
+      for ( char c = 'a'; c < 'a' + 4; ++c ) {
+        test.execute( ExpectMessage {}.with_data( segment( c ) ) );
+      }
+      test.execute( ack( isn + 1 ).with_win( WINDOW - 1 ) );
+      test.execute( ack( isn + 1 ).with_win( WINDOW - 2 ) );
+      test.execute( ack( isn + 1 ).with_win( WINDOW - 3 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectInRecovery { false } );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPSenderTestHarness test { "After a timeout, each partial ACK repairs the next hole",
+                                  sender_config( isn, 2 * WINDOW ),
+                                  FromConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( ack( isn + 1 ) );
+      test.execute( Push { segment( 'a' ) + segment( 'b' ) + segment( 'c' ) } );
+      for ( char c = 'a'; c < 'a' + 3; ++c ) {
+        test.execute( ExpectMessage {}.with_data( segment( c ) ) );
+      }
+      test.execute( Tick { TCPConfig::TIMEOUT_DFLT } );
+      test.execute( ExpectMessage {}.with_data( segment( 'a' ) ) );
+      test.execute( ExpectCongestionWindow { mss } );
+      test.execute( ack( isn + 1 + mss ) );
+      test.execute( ExpectMessage {}.with_data( segment( 'b' ) ).with_seqno( isn + 1 + mss ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ack( isn + 1 + 3 * mss ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
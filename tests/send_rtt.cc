@@ -0,0 +1,117 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.min_rt_timeout = 10;
+      cfg.congestion_control = TCPConfig::CongestionControl::None;
+
+      TCPSenderTestHarness test { "RTO follows the measured RTT", cfg, FromConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( ExpectRTO { 1000 } );
+      test.execute( Tick { 100 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } } );
+      // first sample: SRTT = R, RTTVAR = R/2, RTO = SRTT + 4 * RTTVAR
+      test.execute( ExpectSmoothedRTT { 100 } );
+      test.execute( ExpectRTTVariation { 50 } );
+      test.execute( ExpectRTO { 300 } );
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ).with_seqno( isn + 1 ) );
+      test.execute( Tick { 299 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_data( "abc" ).with_seqno( isn + 1 ) );
+      test.execute( ExpectRTO { 600 } );
+      test.execute( Tick { 50 } );
+      // Karn's rule: the ack of a retransmitted segment is not a sample, and the backed-off RTO stays
+      test.execute( AckReceived { Wrap32 { isn + 4 } } );
+      test.execute( ExpectSmoothedRTT { 100 } );
+      test.execute( ExpectRTO { 600 } );
+      test.execute( Push { "d" } );
+      test.execute( ExpectMessage {}.with_data( "d" ).with_seqno( isn + 4 ) );
+      test.execute( Tick { 20 } );
+      test.execute( AckReceived { Wrap32 { isn + 5 } } );
+      // RTTVAR = 3/4 * 50 + 1/4 * |100 - 20| = 57.5, SRTT = 7/8 * 100 + 1/8 * 20 = 90
+      test.execute( ExpectSmoothedRTT { 90 } );
+      test.execute( ExpectRTTVariation { 57 } );
+      test.execute( ExpectRTO { 320 } );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.min_rt_timeout = 200;
+      cfg.congestion_control = TCPConfig::CongestionControl::None;
+
+      TCPSenderTestHarness test { "Fast path is clamped to the minimum RTO", cfg, FromConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( Tick { 1 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } } );
+      test.execute( ExpectSmoothedRTT { 1 } );
+      test.execute( ExpectRTO { 200 } );
+      test.execute( Push { "lost" } );
+      test.execute( ExpectMessage {}.with_data( "lost" ) );
+      test.execute( Tick { 199 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_data( "lost" ) );
+      test.execute( ExpectConsecutiveRetransmissions { 1 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.max_rt_timeout = 3000;
+      cfg.congestion_control = TCPConfig::CongestionControl::None;
+
+      TCPSenderTestHarness test { "Backoff stops at the maximum RTO", cfg, FromConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( Tick { 1000 } );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( ExpectRTO { 2000 } );
+      test.execute( Tick { 2000 } );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( ExpectRTO { 3000 } );
+      test.execute( Tick { 3000 } );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( ExpectRTO { 3000 } );
+      test.execute( Tick { 2999 } );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      cfg.rt_timeout = 50;
+      cfg.min_rt_timeout = 100;
+      cfg.max_rt_timeout = 400;
+
+      TCPSenderTestHarness test { "Initial RTO is clamped too", cfg, FromConfig {} };
+      test.execute( ExpectRTO { 100 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
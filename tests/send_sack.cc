@@ -0,0 +1,115 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+    const uint64_t mss = TCPConfig::MAX_PAYLOAD_SIZE;
+
+    {
+      const Wrap32 isn( rd() );
+      TCPSenderTestHarness test { "SYN permits SACK", sender_config( isn, 2 * WINDOW ), FromConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_sack_permitted( true ) );
+      test.execute( ack( isn + 1 ) );
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ).with_sack_permitted( false ) );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = sender_config( isn, 2 * WINDOW );
+      cfg.sack = false;
+      TCPSenderTestHarness test { "SACK disabled in the config", cfg, FromConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_sack_permitted( false ) );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPSenderTestHarness test { "Classic sender does not offer SACK", TCPConfig { .isn = isn } };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_sack_permitted( false ) );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPSenderTestHarness test {
+        "SACK repairs two holes in one round trip", sender_config( isn, 2 * WINDOW ), FromConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( Tick { 10 } );
+      test.execute( ack( isn + 1 ) );
+      test.execute( Push { segment( 'a' ) + segment( 'b' ) + segment( 'c' ) + segment( 'd' ) + segment( 'e' )
+                           + segment( 'f' ) } );
+      for ( char c = 'a'; c < 'a' + 6; ++c ) {
+        test.execute( ExpectMessage {}.with_data( segment( c ) ) );
+      }
+
+      // "a" and "c" were lost; the duplicate ACKs say exactly what arrived
+      const Wrap32 a = isn + 1;
+      const Wrap32 b = a + mss;
+      const Wrap32 c = b + mss;
+      const Wrap32 d = c + mss;
+      test.execute( Tick { 10 } );
+      test.execute( ack( a ).with_sack( b, c ) );
+      test.execute( ack( a ).with_sack( d, d + mss ).with_sack( b, c ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ack( a ).with_sack( d, d + 2 * mss ).with_sack( b, c ) );
+      test.execute( ExpectMessage {}.with_data( segment( 'a' ) ).with_seqno( a ) );
+      test.execute( ExpectInRecovery { true } );
+      test.execute( ExpectNoSegment {} );
+
+      // once PRR allows it, "c" goes out too, without waiting for the ACK of "a"; sacked segments never do
+      test.execute( ack( a ).with_sack( d, d + 3 * mss ).with_sack( b, c ) );
+      test.execute( ExpectMessage {}.with_data( segment( 'c' ) ).with_seqno( c ) );
+      test.execute( ExpectNoSegment {} );
+
+      test.execute( ack( c ).with_sack( d, d + 3 * mss ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ack( d + 3 * mss ) );
+      test.execute( ExpectInRecovery { false } );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+      test.execute( ExpectConsecutiveRetransmissions { 0 } );
+      // RACK, on by default, marked both holes itself; no probe was needed
+      test.execute( ExpectRackLosses { 2 } );
+      test.execute( ExpectTailLossProbes { 0 } );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPSenderTestHarness test {
+        "SACK blocks outside the flight are ignored", sender_config( isn, 2 * WINDOW ), FromConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( Tick { 10 } );
+      test.execute( ack( isn + 1 ) );
+      test.execute( Push { segment( 'a' ) + segment( 'b' ) + segment( 'c' ) } );
+      for ( char c = 'a'; c < 'a' + 3; ++c ) {
+        test.execute( ExpectMessage {}.with_data( segment( c ) ) );
+      }
+
+      // a block past anything sent and a block below the ackno mark nothing
+      const Wrap32 data = isn + 1;
+      test.execute( Tick { 10 } );
+      test.execute( ack( data + mss ).with_sack( data + 3 * mss, data + 4 * mss ).with_sack( isn, data ) );
+      test.execute( ExpectSeqnosInFlight { 2 * mss } );
+      test.execute( Tick { 1000 } );
+      test.execute( ExpectMessage {}.with_data( segment( 'b' ) ) );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,231 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+    const uint64_t mss = TCPConfig::MAX_PAYLOAD_SIZE - TCPConfig::TIMESTAMPS_LEN;
+
+    {
+      const Wrap32 isn( rd() );
+      TCPSenderTestHarness test {
+        "Every segment is stamped with the sender's clock", sender_config( isn, 2 * WINDOW ), FromConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_timestamp( 0 ) );
+      test.execute( SetPeerTimestamps { true } );
+      test.execute( ExpectMSS { mss } );
+      test.execute( Tick { 5 } );
+      test.execute( ack( isn + 1, 0 ) );
+      test.execute( ExpectSmoothedRTT { 5 } );
+      test.execute( Tick { 10 } );
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ).with_timestamp( 15 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPSenderTestHarness test {
+        "No timestamps unless the peer's SYN has them", sender_config( isn, 2 * WINDOW ), FromConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_timestamp( 0 ) );
+      test.execute( SetPeerTimestamps { false } );
+      test.execute( ExpectMSS { TCPConfig::MAX_PAYLOAD_SIZE } );
+      test.execute( ack( isn + 1 ) );
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ).with_timestamp( nullopt ) );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = sender_config( isn, 2 * WINDOW );
+      cfg.timestamps = false;
+      TCPSenderTestHarness test { "No timestamps when disabled locally", cfg, FromConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_timestamp( nullopt ) );
+      test.execute( SetPeerTimestamps { true } );
+      test.execute( ack( isn + 1 ) );
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ).with_timestamp( nullopt ) );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPSenderTestHarness test {
+        "A retransmitted segment is timed through the echo", sender_config( isn, 2 * WINDOW ), FromConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( SetPeerTimestamps { true } );
+      test.execute( Tick { 10 } );
+      test.execute( ack( isn + 1, 0 ) );
+      test.execute( ExpectSmoothedRTT { 10 } );
+      test.execute( ExpectRTO { 200 } );
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ).with_timestamp( 10 ) );
+      test.execute( Tick { 200 } );
+      test.execute( ExpectMessage {}.with_data( "abc" ).with_timestamp( 210 ) );
+      test.execute( Tick { 5 } );
+      test.execute( ack( isn + 4, 210 ) );
+      test.execute( ExpectSmoothedRTT { 9 } );
+      test.execute( ExpectSpuriousTimeouts { 0 } );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPSenderTestHarness test {
+        "Eifel undoes a spurious timeout", sender_config( isn, 2 * WINDOW ), FromConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( SetPeerTimestamps { true } );
+      test.execute( Tick { 10 } );
+      test.execute( ack( isn + 1, 0 ) );
+      test.execute( ExpectCongestionWindow { 10 * mss } );
+      test.execute( Push { string( 4 * mss, 'x' ) } );
+      for ( int i = 0; i < 4; i++ ) {
+        test.execute( ExpectMessage {}.with_payload_size( mss ).with_timestamp( 10 ) );
+      }
+      test.execute( Tick { 200 } );
+      test.execute( ExpectMessage {}.with_seqno( isn + 1 ).with_timestamp( 210 ) );
+      test.execute( ExpectCongestionWindow { mss } );
+
+      // the ACK echoes the first transmission, so that one arrived: the timeout was only a delay
+      test.execute( ack( isn + 1 + mss, 10 ) );
+      test.execute( ExpectSpuriousTimeouts { 1 } );
+      test.execute( ExpectCongestionWindow { 10 * mss } );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPSenderTestHarness test {
+        "Eifel keeps the reduction after a real loss", sender_config( isn, 2 * WINDOW ), FromConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( SetPeerTimestamps { true } );
+      test.execute( Tick { 10 } );
+      test.execute( ack( isn + 1, 0 ) );
+      test.execute( Push { string( 4 * mss, 'x' ) } );
+      for ( int i = 0; i < 4; i++ ) {
+        test.execute( ExpectMessage {}.with_payload_size( mss ) );
+      }
+      test.execute( Tick { 200 } );
+      test.execute( ExpectMessage {}.with_seqno( isn + 1 ).with_timestamp( 210 ) );
+
+      // the ACK echoes the retransmission: the original was lost, and recovery goes on
+      test.execute( ack( isn + 1 + mss, 210 ) );
+      test.execute( ExpectSpuriousTimeouts { 0 } );
+      test.execute( ExpectCongestionWindow { 2 * mss } );
+      test.execute( ExpectMessage {}.with_seqno( isn + 1 + mss ).with_timestamp( 210 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    const uint64_t full = TCPConfig::MAX_PAYLOAD_SIZE;
+    const auto segment = [&]( char c ) { return string( full, c ); };
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = sender_config( isn, 2 * WINDOW );
+      cfg.timestamps = false;
+      cfg.frto = true;
+      TCPSenderTestHarness test { "F-RTO sends new data, then undoes a spurious timeout", cfg, FromConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( Tick { 10 } );
+      test.execute( ack( isn + 1 ) );
+      string data;
+      for ( char c = 'a'; c < 'a' + 12; ++c ) {
+        data += segment( c );
+      }
+      test.execute( Push { data } );
+      for ( char c = 'a'; c < 'a' + 10; ++c ) {
+        test.execute( ExpectMessage {}.with_data( segment( c ) ) );
+      }
+      test.execute( Tick { 200 } );
+      test.execute( ExpectMessage {}.with_data( segment( 'a' ) ) );
+      test.execute( ExpectCongestionWindow { full } );
+
+      // the first ACK sends two new segments instead of retransmitting "b"
+      test.execute( ack( isn + 1 + full ) );
+      test.execute( ExpectMessage {}.with_data( segment( 'k' ) ) );
+      test.execute( ExpectMessage {}.with_data( segment( 'l' ) ) );
+      test.execute( ExpectNoSegment {} );
+
+      // the next one acknowledges more of the data sent before the timeout: none of it was lost
+      test.execute( ack( isn + 1 + 2 * full ) );
+      test.execute( ExpectSpuriousTimeouts { 1 } );
+      test.execute( ExpectCongestionWindow { 11 * full } );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = sender_config( isn, 2 * WINDOW );
+      cfg.timestamps = false;
+      cfg.frto = true;
+      TCPSenderTestHarness test { "F-RTO falls back to retransmitting after a duplicate ACK", cfg, FromConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( Tick { 10 } );
+      test.execute( ack( isn + 1 ) );
+      string data;
+      for ( char c = 'a'; c < 'a' + 12; ++c ) {
+        data += segment( c );
+      }
+      test.execute( Push { data } );
+      for ( char c = 'a'; c < 'a' + 10; ++c ) {
+        test.execute( ExpectMessage {}.with_data( segment( c ) ) );
+      }
+      test.execute( Tick { 200 } );
+      test.execute( ExpectMessage {}.with_data( segment( 'a' ) ) );
+      test.execute( ack( isn + 1 + full ) );
+      test.execute( ExpectMessage {}.with_data( segment( 'k' ) ) );
+      test.execute( ExpectMessage {}.with_data( segment( 'l' ) ) );
+
+      // "b" really was lost
+      test.execute( ack( isn + 1 + full ) );
+      test.execute( ExpectMessage {}.with_data( segment( 'b' ) ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSpuriousTimeouts { 0 } );
+      test.execute( ExpectCongestionWindow { 2 * full } );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPSenderTestHarness test {
+        "A repeated SYN does not shrink the MSS again", sender_config( isn, 2 * WINDOW ), FromConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( SetPeerMSS { TCPConfig::MAX_PAYLOAD_SIZE } );
+      test.execute( SetPeerTimestamps { true } );
+      test.execute( ExpectMSS { mss } );
+      // the peer's SYN-ACK arrives twice
+      test.execute( SetPeerMSS { TCPConfig::MAX_PAYLOAD_SIZE } );
+      test.execute( SetPeerTimestamps { true } );
+      test.execute( ExpectMSS { mss } );
+      test.execute( Tick { 10 } );
+      test.execute( ack( isn + 1, 0 ) );
+      test.execute( Push { string( 2 * mss, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( mss ) );
+      test.execute( ExpectMessage {}.with_payload_size( mss ) );
+      // and once more after data has started to flow
+      test.execute( SetPeerMSS { TCPConfig::MAX_PAYLOAD_SIZE } );
+      test.execute( SetPeerTimestamps { true } );
+      test.execute( ExpectMSS { mss } );
+      test.execute( ExpectCongestionWindow { 10 * mss } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
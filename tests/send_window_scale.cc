@@ -0,0 +1,105 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      cfg.recv_capacity = 64000;
+      if ( cfg.recv_window_shift() != 0 ) {
+        throw runtime_error( "a 64000-byte buffer should not need window scaling" );
+      }
+      cfg.recv_capacity = 4'000'000;
+      if ( cfg.recv_window_shift() != 6 ) {
+        throw runtime_error( "a 4 MB buffer should need a window shift of 6" );
+      }
+      cfg.recv_capacity = size_t { 1 } << 40;
+      if ( cfg.recv_window_shift() != TCPConfig::MAX_WINDOW_SHIFT ) {
+        throw runtime_error( "the window shift should be capped at 14" );
+      }
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = sender_config( isn, 1'000'000 );
+      cfg.recv_capacity = 4'000'000;
+      cfg.congestion_control = TCPConfig::CongestionControl::None;
+      TCPSenderTestHarness test { "SYN announces the receive window shift", cfg, FromConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_window_scale( 6 ) );
+      test.execute( SetPeerWindowScale { 0 } );
+      test.execute( AckReceived { isn + 1 } );
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ).with_window_scale( nullopt ) );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = sender_config( isn, 1'000'000 );
+      cfg.recv_capacity = 4'000'000;
+      cfg.window_scale = false;
+      cfg.congestion_control = TCPConfig::CongestionControl::None;
+      TCPSenderTestHarness test { "No window scale option when disabled", cfg, FromConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_window_scale( nullopt ) );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = sender_config( isn, 1'000'000 );
+      cfg.recv_capacity = 4'000'000;
+      cfg.congestion_control = TCPConfig::CongestionControl::None;
+      TCPSenderTestHarness test { "Peer's window is scaled past 64 KB", cfg, FromConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( SetPeerWindowScale { 2 } );
+      test.execute( Receive { { isn + 1, 50000 } } );
+      test.execute( Push { string( 300'000, 'x' ) } );
+      test.execute( ExpectSeqnosInFlight { 200'000 } );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = sender_config( isn, 1'000'000 );
+      cfg.recv_capacity = 4'000'000;
+      cfg.congestion_control = TCPConfig::CongestionControl::None;
+      TCPSenderTestHarness test { "Peer's window is unscaled without its option", cfg, FromConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( SetPeerWindowScale { nullopt } );
+      test.execute( Receive { { isn + 1, 50000 } } );
+      test.execute( Push { string( 300'000, 'x' ) } );
+      test.execute( ExpectSeqnosInFlight { 50000 } );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = sender_config( isn, 1'000'000 );
+      cfg.recv_capacity = 4'000'000;
+      cfg.congestion_control = TCPConfig::CongestionControl::None;
+      TCPSenderTestHarness test { "Peer's shift is capped at 14", cfg, FromConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( SetPeerWindowScale { 20 } );
+      test.execute( Receive { { isn + 1, 10 } } );
+      test.execute( Push { string( 300'000, 'x' ) } );
+      test.execute( ExpectSeqnosInFlight { 10 << 14 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
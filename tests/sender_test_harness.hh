@@ -18,6 +18,7 @@ struct SenderAndOutput
 {
   TCPSender sender;
   std::queue<TCPSenderMessage> output {};
+  size_t max_payload_size { TCPConfig::MAX_PAYLOAD_SIZE };
 
   auto make_transmit()
   {
@@ -80,6 +81,129 @@ struct ExpectConsecutiveRetransmissions : public ExpectNumber<SenderAndOutput, u
   uint64_t value( SenderAndOutput& ss ) const override { return ss.sender.consecutive_retransmissions(); }
 };
 
+struct ExpectRTO : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "current_RTO_ms"; }
+  uint64_t value( SenderAndOutput& ss ) const override { return ss.sender.current_RTO_ms(); }
+};
+
+struct ExpectSmoothedRTT : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "rtt_estimator()->smoothed_RTT_ms"; }
+  uint64_t value( SenderAndOutput& ss ) const override
+  {
+    if ( ss.sender.rtt_estimator() == nullptr ) {
+      throw ExpectationViolation( "TCPSender has no RTT estimator" );
+    }
+    return ss.sender.rtt_estimator()->smoothed_RTT_ms();
+  }
+};
+
+struct ExpectRTTVariation : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "rtt_estimator()->RTT_variation_ms"; }
+  uint64_t value( SenderAndOutput& ss ) const override
+  {
+    if ( ss.sender.rtt_estimator() == nullptr ) {
+      throw ExpectationViolation( "TCPSender has no RTT estimator" );
+    }
+    return ss.sender.rtt_estimator()->RTT_variation_ms();
+  }
+};
+
+struct ExpectCongestionWindow : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "congestion_window"; }
+  uint64_t value( SenderAndOutput& ss ) const override { return ss.sender.congestion_window(); }
+};
+
+struct ExpectSlowStartThreshold : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "ssthresh"; }
+  uint64_t value( SenderAndOutput& ss ) const override
+  {
+    if ( ss.sender.congestion_controller() == nullptr ) {
+      throw ExpectationViolation( "TCPSender has no congestion controller" );
+    }
+    return ss.sender.congestion_controller()->ssthresh();
+  }
+};
+
+struct ExpectPacingRate : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "pacing_rate"; }
+  uint64_t value( SenderAndOutput& ss ) const override { return ss.sender.pacing_rate(); }
+};
+
+struct ExpectMSS : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "MSS"; }
+  uint64_t value( SenderAndOutput& ss ) const override { return ss.sender.MSS(); }
+};
+
+struct ExpectSpuriousTimeouts : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "stats().spurious_timeouts"; }
+  uint64_t value( SenderAndOutput& ss ) const override { return ss.sender.stats().spurious_timeouts; }
+};
+
+struct ExpectRackLosses : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "stats().rack_losses"; }
+  uint64_t value( SenderAndOutput& ss ) const override { return ss.sender.stats().rack_losses; }
+};
+
+struct ExpectTailLossProbes : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "stats().tail_loss_probes"; }
+  uint64_t value( SenderAndOutput& ss ) const override { return ss.sender.stats().tail_loss_probes; }
+};
+
+struct ExpectDeliveryRate : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "rate_sample().delivery_rate"; }
+  uint64_t value( SenderAndOutput& ss ) const override { return ss.sender.rate_sample().delivery_rate; }
+};
+
+struct ExpectRateAppLimited : public ExpectBool<SenderAndOutput>
+{
+  using ExpectBool::ExpectBool;
+  std::string name() const override { return "rate_sample().app_limited"; }
+  bool value( SenderAndOutput& ss ) const override { return ss.sender.rate_sample().app_limited; }
+};
+
+struct ExpectECNReductions : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "stats().ecn_reductions"; }
+  uint64_t value( SenderAndOutput& ss ) const override { return ss.sender.stats().ecn_reductions; }
+};
+
+struct ExpectAvailableCapacity : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "writer().available_capacity"; }
+  uint64_t value( SenderAndOutput& ss ) const override { return ss.sender.writer().available_capacity(); }
+};
+
+struct ExpectInRecovery : public ExpectBool<SenderAndOutput>
+{
+  using ExpectBool::ExpectBool;
+  std::string name() const override { return "in_recovery"; }
+  bool value( SenderAndOutput& ss ) const override { return ss.sender.in_recovery(); }
+};
+
 struct ExpectNoSegment : public Expectation<SenderAndOutput>
 {
   std::string description() const override { return "nothing to send"; }
@@ -192,7 +316,17 @@ struct Receive : public Action<SenderAndOutput>
   std::string description() const override
   {
     std::ostringstream desc;
-    desc << "receive(ack=" << to_string( msg_.ackno ) << ", win=" << msg_.window_size << ")";
+    desc << "receive(ack=" << to_string( msg_.ackno ) << ", win=" << msg_.window_size;
+    for ( const auto& block : msg_.sack() ) {
+      desc << ", sack=[" << block.begin << ", " << block.end << ")";
+    }
+    if ( msg_.timestamp_echo.has_value() ) {
+      desc << ", tsecr=" << msg_.timestamp_echo.value();
+    }
+    if ( msg_.ECE ) {
+      desc << ", +ECE";
+    }
+    desc << ")";
     if ( push_ ) {
       desc << ", then push stream to TCPSender";
     }
@@ -213,6 +347,24 @@ struct Receive : public Action<SenderAndOutput>
     }
   }
 
+  Receive& with_sack( Wrap32 begin, Wrap32 end )
+  {
+    msg_.sack_blocks.at( msg_.num_sack_blocks++ ) = { begin, end };
+    return *this;
+  }
+
+  Receive& with_timestamp_echo( uint32_t tsecr )
+  {
+    msg_.timestamp_echo = tsecr;
+    return *this;
+  }
+
+  Receive& with_ece()
+  {
+    msg_.ECE = true;
+    return *this;
+  }
+
   Receive& without_push()
   {
     push_ = false;
@@ -225,6 +377,67 @@ struct AckReceived : public Receive
   explicit AckReceived( Wrap32 ackno ) : Receive( { ackno, DEFAULT_TEST_WINDOW } ) {}
 };
 
+struct SetPeerMSS : public Action<SenderAndOutput>
+{
+  uint16_t mss_;
+
+  explicit SetPeerMSS( uint16_t mss ) : mss_( mss ) {}
+  std::string description() const override { return "peer's SYN announces MSS=" + std::to_string( mss_ ); }
+  void execute( SenderAndOutput& ss ) const override { ss.sender.set_peer_MSS( mss_ ); }
+};
+
+struct SetPeerWindowScale : public Action<SenderAndOutput>
+{
+  std::optional<uint8_t> shift_;
+
+  explicit SetPeerWindowScale( std::optional<uint8_t> shift ) : shift_( shift ) {}
+  std::string description() const override
+  {
+    return "peer's SYN announces "
+           + ( shift_.has_value() ? "window scale=" + std::to_string( *shift_ ) : std::string { "no window scale" } );
+  }
+  void execute( SenderAndOutput& ss ) const override { ss.sender.set_peer_window_scale( shift_ ); }
+};
+
+struct SetPeerTimestamps : public Action<SenderAndOutput>
+{
+  bool timestamps_;
+
+  explicit SetPeerTimestamps( bool timestamps ) : timestamps_( timestamps ) {}
+  std::string description() const override
+  {
+    return std::string { "peer's SYN " } + ( timestamps_ ? "carries" : "lacks" ) + " the timestamps option";
+  }
+  void execute( SenderAndOutput& ss ) const override { ss.sender.set_peer_timestamps( timestamps_ ); }
+};
+
+struct SetPeerECN : public Action<SenderAndOutput>
+{
+  bool ecn_;
+
+  explicit SetPeerECN( bool ecn ) : ecn_( ecn ) {}
+  std::string description() const override
+  {
+    return std::string { "peer's SYN " } + ( ecn_ ? "requests" : "does not request" ) + " ECN";
+  }
+  void execute( SenderAndOutput& ss ) const override { ss.sender.set_peer_ECN( ecn_ ); }
+};
+
+struct SetCorked : public Action<SenderAndOutput>
+{
+  bool corked_;
+
+  explicit SetCorked( bool corked ) : corked_( corked ) {}
+  std::string description() const override { return corked_ ? "cork" : "uncork, then push to TCPSender"; }
+  void execute( SenderAndOutput& ss ) const override
+  {
+    ss.sender.set_corked( corked_ );
+    if ( not corked_ ) {
+      ss.sender.push( ss.make_transmit() );
+    }
+  }
+};
+
 struct Close : public Push
 {
   Close() : Push( "" ) { with_close(); }
@@ -235,6 +448,13 @@ struct ExpectMessage : public Expectation<SenderAndOutput>
   std::optional<bool> syn {};
   std::optional<bool> fin {};
   std::optional<bool> rst {};
+  std::optional<bool> sack_permitted {};
+  std::optional<uint16_t> mss {};
+  std::optional<std::optional<uint8_t>> window_scale {};
+  std::optional<std::optional<uint32_t>> timestamp {};
+  std::optional<bool> ecn {};
+  std::optional<bool> cwr {};
+  std::optional<bool> ect {};
   std::optional<Wrap32> seqno {};
   std::optional<std::string> data {};
   std::optional<size_t> payload_size {};
@@ -263,6 +483,48 @@ struct ExpectMessage : public Expectation<SenderAndOutput>
     return *this;
   }
 
+  ExpectMessage& with_sack_permitted( bool sack_permitted_ )
+  {
+    sack_permitted = sack_permitted_;
+    return *this;
+  }
+
+  ExpectMessage& with_mss( uint16_t mss_ )
+  {
+    mss = mss_;
+    return *this;
+  }
+
+  ExpectMessage& with_window_scale( std::optional<uint8_t> window_scale_ )
+  {
+    window_scale = window_scale_;
+    return *this;
+  }
+
+  ExpectMessage& with_timestamp( std::optional<uint32_t> timestamp_ )
+  {
+    timestamp = timestamp_;
+    return *this;
+  }
+
+  ExpectMessage& with_ecn( bool ecn_ )
+  {
+    ecn = ecn_;
+    return *this;
+  }
+
+  ExpectMessage& with_cwr( bool cwr_ )
+  {
+    cwr = cwr_;
+    return *this;
+  }
+
+  ExpectMessage& with_ect( bool ect_ )
+  {
+    ect = ect_;
+    return *this;
+  }
+
   ExpectMessage& with_seqno( Wrap32 seqno_ )
   {
     seqno = seqno_;
@@ -308,6 +570,27 @@ struct ExpectMessage : public Expectation<SenderAndOutput>
     if ( rst.has_value() ) {
       o << ( rst.value() ? " +RST" : " (no RST)" );
     }
+    if ( sack_permitted.has_value() ) {
+      o << ( sack_permitted.value() ? " +SACK-permitted" : " (no SACK-permitted)" );
+    }
+    if ( mss.has_value() ) {
+      o << " MSS=" << mss.value();
+    }
+    if ( window_scale.has_value() ) {
+      o << ( window_scale->has_value() ? " wscale=" + std::to_string( **window_scale ) : " (no wscale)" );
+    }
+    if ( timestamp.has_value() ) {
+      o << ( timestamp->has_value() ? " tsval=" + std::to_string( **timestamp ) : " (no timestamp)" );
+    }
+    if ( ecn.has_value() ) {
+      o << ( ecn.value() ? " +ECN" : " (no ECN)" );
+    }
+    if ( cwr.has_value() ) {
+      o << ( cwr.value() ? " +CWR" : " (no CWR)" );
+    }
+    if ( ect.has_value() ) {
+      o << ( ect.value() ? " ECT" : " (not ECT)" );
+    }
     return o.str();
   }
 
@@ -334,13 +617,42 @@ struct ExpectMessage : public Expectation<SenderAndOutput>
     if ( rst.has_value() and seg.RST != rst.value() ) {
       throw ExpectationViolation( "RST flag", rst.value(), seg.RST );
     }
+    if ( sack_permitted.has_value() and seg.SACK_permitted != sack_permitted.value() ) {
+      throw ExpectationViolation( "SACK-permitted option", sack_permitted.value(), seg.SACK_permitted );
+    }
+    if ( mss.has_value() and seg.MSS != mss.value() ) {
+      throw ExpectationViolation( "MSS option", mss.value(), seg.MSS );
+    }
+    if ( window_scale.has_value() and seg.window_scale != window_scale.value() ) {
+      const auto show = []( std::optional<uint8_t> shift ) {
+        return shift.has_value() ? std::to_string( *shift ) : std::string { "none" };
+      };
+      throw ExpectationViolation( "The window-scale option should have been " + show( window_scale.value() )
+                                  + ", but instead it was " + show( seg.window_scale ) );
+    }
+    if ( timestamp.has_value() and seg.timestamp != timestamp.value() ) {
+      const auto show = []( std::optional<uint32_t> ts ) {
+        return ts.has_value() ? std::to_string( *ts ) : std::string { "none" };
+      };
+      throw ExpectationViolation( "The timestamp should have been " + show( timestamp.value() )
+                                  + ", but instead it was " + show( seg.timestamp ) );
+    }
+    if ( ecn.has_value() and seg.ECN != ecn.value() ) {
+      throw ExpectationViolation( "ECN flag", ecn.value(), seg.ECN );
+    }
+    if ( cwr.has_value() and seg.CWR != cwr.value() ) {
+      throw ExpectationViolation( "CWR flag", cwr.value(), seg.CWR );
+    }
+    if ( ect.has_value() and seg.ECT != ect.value() ) {
+      throw ExpectationViolation( "ECT codepoint", ect.value(), seg.ECT );
+    }
     if ( seqno.has_value() and seg.seqno != seqno.value() ) {
       throw ExpectationViolation( "sequence number", seqno.value(), seg.seqno );
     }
     if ( payload_size.has_value() and seg.payload.size() != payload_size.value() ) {
       throw ExpectationViolation( "payload_size", payload_size.value(), seg.payload.size() );
     }
-    if ( seg.payload.size() > TCPConfig::MAX_PAYLOAD_SIZE ) {
+    if ( seg.payload.size() > ss.max_payload_size ) {
       throw ExpectationViolation( "payload has length (" + std::to_string( seg.payload.size() )
                                   + ") greater than the maximum" );
     }
@@ -353,6 +665,38 @@ struct ExpectMessage : public Expectation<SenderAndOutput>
   }
 };
 
+//! Selects the TCPSender( ByteStream&&, const TCPConfig& ) constructor (adaptive RTO, congestion control)
+struct FromConfig
+{};
+
+//! A TCPConfig with the given ISN and send buffer; each test sets the options it exercises on top
+inline TCPConfig sender_config( Wrap32 isn, size_t send_capacity = TCPConfig::DEFAULT_CAPACITY )
+{
+  TCPConfig cfg;
+  cfg.isn = isn;
+  cfg.send_capacity = send_capacity;
+  return cfg;
+}
+
+//! The receive window the peer advertises in these tests: big enough that only cwnd limits the sender
+constexpr uint16_t WINDOW = 60000;
+
+//! One full-sized segment of a distinct letter, so that the segments can be told apart
+inline std::string segment( char c )
+{
+  return std::string( TCPConfig::MAX_PAYLOAD_SIZE, c );
+}
+
+inline Receive ack( Wrap32 ackno )
+{
+  return Receive { { ackno, WINDOW } };
+}
+
+inline Receive ack( Wrap32 ackno, uint32_t tsecr )
+{
+  return ack( ackno ).with_timestamp_echo( tsecr );
+}
+
 class TCPSenderTestHarness : public TestHarness<SenderAndOutput>
 {
 public:
@@ -361,4 +705,21 @@ public:
                    "initial_RTO_ms=" + to_string( config.rt_timeout ),
                    { TCPSender { ByteStream { config.send_capacity }, config.isn, config.rt_timeout } } )
   {}
+
+  TCPSenderTestHarness( std::string name, const TCPConfig& config, FromConfig /* unused */ )
+    : TestHarness( move( name ),
+                   "initial_RTO_ms=" + to_string( config.rt_timeout ) + ", min_RTO_ms="
+                     + to_string( config.min_rt_timeout ) + ", max_RTO_ms=" + to_string( config.max_rt_timeout ),
+                   { TCPSender { ByteStream { config.send_capacity }, config }, {}, config.mss } )
+  {}
 };
+
+//! The handshake with a 10 ms round trip, which leaves SRTT = min RTT = 10 ms
+inline void connect( TCPSenderTestHarness& test, Wrap32 isn )
+{
+  test.execute( Push {} );
+  test.execute( ExpectMessage {}.with_syn( true ) );
+  test.execute( Tick { 10 } );
+  test.execute( ack( isn + 1 ) );
+  test.execute( ExpectSmoothedRTT { 10 } );
+}
@@ -0,0 +1,71 @@
+#include "buffer_pool.hh"
+
+#include <utility>
+
+using namespace std;
+
+namespace {
+constexpr array<size_t, 2> CLASS_SIZES { BufferPool::SMALL_CLASS, BufferPool::LARGE_CLASS };
+}
+
+string BufferPool::acquire( size_t size )
+{
+  for ( size_t i = 0; i < CLASS_SIZES.size(); ++i ) {
+    if ( size > CLASS_SIZES[i] ) {
+      continue;
+    }
+
+    auto& free_list = free_[i];
+    if ( free_list.empty() ) {
+      ++stats_.misses;
+      string ret;
+      ret.reserve( CLASS_SIZES[i] );
+      return ret;
+    }
+
+    ++stats_.hits;
+    string ret = move( free_list.back() );
+    free_list.pop_back();
+    return ret;
+  }
+
+  ++stats_.misses;
+  string ret;
+  ret.reserve( size );
+  return ret;
+}
+
+void BufferPool::release( string&& buffer )
+{
+  // A buffer belongs to the largest class it can hold, unless it is so big that keeping it would waste memory.
+  const size_t capacity = buffer.capacity();
+  for ( size_t i = CLASS_SIZES.size(); i-- > 0; ) {
+    if ( capacity < CLASS_SIZES[i] ) {
+      continue;
+    }
+
+    auto& free_list = free_[i];
+    if ( capacity > 4 * CLASS_SIZES[i] or free_list.size() >= MAX_FREE_PER_CLASS ) {
+      break;
+    }
+
+    if ( free_list.capacity() == 0 ) {
+      free_list.reserve( MAX_FREE_PER_CLASS );
+    }
+    buffer.clear();
+    free_list.push_back( move( buffer ) );
+    ++stats_.recycled;
+    return;
+  }
+
+  if ( capacity != string {}.capacity() ) { // strings using the small-string buffer never allocated
+    ++stats_.dropped;
+  }
+  string {}.swap( buffer );
+}
+
+BufferPool& BufferPool::local()
+{
+  thread_local BufferPool pool;
+  return pool;
+}
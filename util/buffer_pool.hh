@@ -0,0 +1,44 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A per-thread free list of std::string buffers, so that the strings that carry payloads
+// through the stack (reads from a FileDescriptor, TCP payloads, out-of-order substrings)
+// can be recycled instead of being allocated and freed for every segment.
+//
+// Buffers come in two size classes: one big enough for any MSS-sized payload, and one
+// matching FileDescriptor's read size. Larger requests are served by the allocator.
+class BufferPool
+{
+public:
+  static constexpr size_t SMALL_CLASS = 2048;         // fits any MSS-sized payload
+  static constexpr size_t LARGE_CLASS = 16384;        // matches FileDescriptor::kReadBufferSize
+  static constexpr size_t MAX_FREE_PER_CLASS = 1024; // bound on idle buffers kept per class
+
+  struct Stats
+  {
+    uint64_t hits {};     // acquire() served from the free list
+    uint64_t misses {};   // acquire() had to allocate
+    uint64_t recycled {}; // release() kept the buffer for reuse
+    uint64_t dropped {};  // release() freed the buffer (wrong size, or the free list was full)
+  };
+
+  // Return an empty string whose capacity is at least `size`
+  std::string acquire( size_t size );
+
+  // Give back a string whose contents are no longer needed, so its storage can be reused
+  void release( std::string&& buffer );
+
+  const Stats& stats() const { return stats_; }
+
+  // The calling thread's pool
+  static BufferPool& local();
+
+private:
+  std::array<std::vector<std::string>, 2> free_ {}; // idle buffers, indexed by size class
+  Stats stats_ {};
+};
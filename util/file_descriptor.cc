@@ -1,5 +1,6 @@
 #include "file_descriptor.hh"
 
+#include "buffer_pool.hh"
 #include "exception.hh"
 
 #include <algorithm>
@@ -83,14 +84,20 @@ FileDescriptor FileDescriptor::duplicate() const
 void FileDescriptor::read( string& buffer )
 {
   if ( buffer.empty() ) {
+    buffer = BufferPool::local().acquire( kReadBufferSize );
     buffer.resize( kReadBufferSize );
   }
 
+  buffer.resize( read( span<char> { buffer } ) );
+}
+
+// buffer is the memory to be read into
+size_t FileDescriptor::read( span<char> buffer )
+{
   const ssize_t bytes_read = ::read( fd_num(), buffer.data(), buffer.size() );
   if ( bytes_read < 0 ) {
     if ( internal_fd_->non_blocking_ and ( errno == EAGAIN or errno == EINPROGRESS ) ) {
-      buffer.clear();
-      return;
+      return 0;
     }
     throw unix_error { "read" };
   }
@@ -105,7 +112,7 @@ void FileDescriptor::read( string& buffer )
     throw runtime_error( "read() read more than requested" );
   }
 
-  buffer.resize( bytes_read );
+  return bytes_read;
 }
 
 void FileDescriptor::read( vector<string>& buffers )
@@ -114,6 +121,9 @@ void FileDescriptor::read( vector<string>& buffers )
     return;
   }
 
+  if ( buffers.back().capacity() < kReadBufferSize ) {
+    buffers.back() = BufferPool::local().acquire( kReadBufferSize );
+  }
   buffers.back().clear();
   buffers.back().resize( kReadBufferSize );
 
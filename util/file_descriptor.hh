@@ -3,6 +3,8 @@
 #include <cstddef>
 #include <limits>
 #include <memory>
+#include <span>
+#include <string_view>
 #include <vector>
 
 // A reference-counted handle to a file descriptor
@@ -65,6 +67,16 @@ public:
   void read( std::string& buffer );
   void read( std::vector<std::string>& buffers );
 
+  // Read into caller-owned memory
+  // returns number of bytes read (0 on EOF, or if a non-blocking fd has nothing to read)
+  size_t read( std::span<char> buffer );
+
+  // Read straight into the free space of a stream writer (anything with reserve()/commit(),
+  // e.g. a ByteStream Writer), with no intermediate buffer
+  // returns number of bytes read
+  template<class WriterT>
+  size_t read_into( WriterT& writer );
+
   // Attempt to write a buffer
   // returns number of bytes written
   size_t write( std::string_view buffer );
@@ -97,3 +109,15 @@ public:
   FileDescriptor( FileDescriptor&& other ) = default;                // move construction is allowed
   FileDescriptor& operator=( FileDescriptor&& other ) = default;     // move assignment is allowed
 };
+
+template<class WriterT>
+size_t FileDescriptor::read_into( WriterT& writer )
+{
+  const std::span<char> space = writer.reserve( writer.available_capacity() );
+  if ( space.empty() ) {
+    return 0; // a zero-length read would look like EOF
+  }
+  const size_t bytes_read = read( space );
+  writer.commit( bytes_read );
+  return bytes_read;
+}
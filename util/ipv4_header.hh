@@ -13,6 +13,13 @@ struct IPv4Header
   static constexpr uint8_t DEFAULT_TTL = 128; // A reasonable default TTL value
   static constexpr uint8_t PROTO_TCP = 6;     // Protocol number for TCP
 
+  // ECN codepoints in the low two bits of the type-of-service byte (RFC 3168)
+  static constexpr uint8_t ECN_MASK = 0b11;
+  static constexpr uint8_t ECN_NOT_ECT = 0b00; // the transport does not understand ECN
+  static constexpr uint8_t ECN_ECT1 = 0b01;    // ECN-capable transport
+  static constexpr uint8_t ECN_ECT0 = 0b10;    // ECN-capable transport
+  static constexpr uint8_t ECN_CE = 0b11;      // Congestion Experienced: marked by a router instead of dropped
+
   static constexpr uint64_t serialized_length() { return LENGTH; }
 
   /*
@@ -48,6 +55,13 @@ struct IPv4Header
   uint32_t src = 0;          // src address
   uint32_t dst = 0;          // dst address
 
+  // ECN codepoint of the datagram
+  uint8_t ecn() const { return tos & ECN_MASK; }
+  void set_ecn( uint8_t codepoint )
+  {
+    tos = static_cast<uint8_t>( ( tos & ~ECN_MASK ) | ( codepoint & ECN_MASK ) );
+  }
+
   // Length of the payload
   uint16_t payload_length() const;
 
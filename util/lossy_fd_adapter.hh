@@ -1,6 +1,7 @@
 #pragma once
 
 #include "file_descriptor.hh"
+#include "ipv4_header.hh"
 #include "random.hh"
 #include "tcp_config.hh"
 #include "tcp_segment.hh"
@@ -30,6 +31,15 @@ private:
     return loss != 0 && static_cast<uint16_t>( _rand() ) < loss;
   }
 
+  //! \brief Determine whether an outbound segment is too big for the simulated path MTU
+  //! \param[in] seg is the packet to be written
+  //! \returns `true` if the IPv4 datagram carrying the segment would exceed the path MTU
+  bool _exceeds_path_mtu( const TCPMessage& seg ) const
+  {
+    const uint16_t mtu = _adapter.config().path_mtu;
+    return mtu != 0 && IPv4Header::LENGTH + TCPSegment::header_length( seg ) + seg.sender.payload.size() > mtu;
+  }
+
 public:
   //! Conversion to a FileDescriptor by returning the underlying AdapterT
   FileDescriptor& fd() { return _adapter.fd(); }
@@ -53,7 +63,7 @@ public:
   //! \param[in] seg is the packet to either write or drop
   void write( const TCPMessage& seg )
   {
-    if ( _should_drop( true ) ) {
+    if ( _should_drop( true ) || _exceeds_path_mtu( seg ) ) {
       return;
     }
     return _adapter.write( seg );
@@ -0,0 +1,95 @@
+#include "mirrored_buffer.hh"
+
+#include "exception.hh"
+#include "file_descriptor.hh"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <utility>
+
+using namespace std;
+
+namespace {
+void* map_or_throw( void* addr, size_t length, int prot, int flags, int fd )
+{
+  void* const ret = mmap( addr, length, prot, flags, fd, 0 );
+  if ( ret == MAP_FAILED ) { // NOLINT(*-cstyle-cast, *-int-to-ptr)
+    throw unix_error { "mmap" };
+  }
+  return ret;
+}
+} // namespace
+
+MirroredBuffer::MirroredBuffer( uint64_t min_size )
+{
+  if ( min_size == 0 ) {
+    return;
+  }
+
+  const auto page_size = static_cast<uint64_t>( sysconf( _SC_PAGESIZE ) );
+  const uint64_t size = bit_ceil( max( min_size, page_size ) );
+
+  // The mappings keep the memfd alive, so the descriptor itself can be closed on return.
+  const FileDescriptor fd { CheckSystemCall( "memfd_create", memfd_create( "minnow-ring", MFD_CLOEXEC ) ) };
+  CheckSystemCall( "ftruncate", ftruncate( fd.fd_num(), static_cast<off_t>( size ) ) );
+
+  // Reserve 2 * size bytes of address space, then overlay both halves with the same file.
+  auto* base = static_cast<char*>( map_or_throw( nullptr, 2 * size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1 ) );
+  try {
+    map_or_throw( base, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd.fd_num() );
+    map_or_throw( base + size, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd.fd_num() );
+  } catch ( ... ) {
+    munmap( base, 2 * size );
+    throw;
+  }
+
+  base_ = base;
+  size_ = size;
+}
+
+void MirroredBuffer::unmap()
+{
+  if ( base_ ) {
+    munmap( base_, 2 * size_ );
+    base_ = nullptr;
+    size_ = 0;
+  }
+}
+
+MirroredBuffer::~MirroredBuffer()
+{
+  unmap();
+}
+
+MirroredBuffer::MirroredBuffer( const MirroredBuffer& other ) : MirroredBuffer( other.size_ )
+{
+  if ( size_ ) {
+    memcpy( base_, other.base_, size_ );
+  }
+}
+
+MirroredBuffer& MirroredBuffer::operator=( const MirroredBuffer& other )
+{
+  if ( this != &other ) {
+    MirroredBuffer copy { other };
+    *this = move( copy );
+  }
+  return *this;
+}
+
+MirroredBuffer::MirroredBuffer( MirroredBuffer&& other ) noexcept
+  : base_( exchange( other.base_, nullptr ) ), size_( exchange( other.size_, 0 ) )
+{}
+
+MirroredBuffer& MirroredBuffer::operator=( MirroredBuffer&& other ) noexcept
+{
+  if ( this != &other ) {
+    unmap();
+    base_ = exchange( other.base_, nullptr );
+    size_ = exchange( other.size_, 0 );
+  }
+  return *this;
+}
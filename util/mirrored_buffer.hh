@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// A fixed-size ring of bytes whose storage (a memfd) is mapped twice, back to back, in
+// virtual memory. Any run of up to size() bytes that starts anywhere in the ring is
+// therefore contiguous, even if it wraps around the end of the ring.
+class MirroredBuffer
+{
+public:
+  // Construct a ring of at least `min_size` bytes, rounded up to a power-of-two number of pages.
+  // A `min_size` of zero creates an empty ring without any mapping.
+  explicit MirroredBuffer( uint64_t min_size = 0 );
+
+  // Unmaps both views of the ring
+  ~MirroredBuffer();
+
+  // Copying creates a new ring of the same size and copies its contents
+  MirroredBuffer( const MirroredBuffer& other );
+  MirroredBuffer& operator=( const MirroredBuffer& other );
+
+  // Moving transfers the mapping; pointers into the ring stay valid
+  MirroredBuffer( MirroredBuffer&& other ) noexcept;
+  MirroredBuffer& operator=( MirroredBuffer&& other ) noexcept;
+
+  uint64_t size() const { return size_; } // number of distinct bytes in the ring
+
+  // Address of ring position `index` (taken modulo size()); the next size() bytes are contiguous.
+  // Must not be called on an empty ring.
+  char* at( uint64_t index ) { return base_ + ( index & ( size_ - 1 ) ); }
+  const char* at( uint64_t index ) const { return base_ + ( index & ( size_ - 1 ) ); }
+
+private:
+  char* base_ {};     // start of the first of the two mappings
+  uint64_t size_ {};  // length of each mapping (a power of two, or zero)
+
+  void unmap();
+};
@@ -0,0 +1,41 @@
+#include "reassembly_budget.hh"
+
+#include <utility>
+
+using namespace std;
+
+ReassemblyBudget::Lease::Lease( Lease&& other ) noexcept
+  : budget_( other.budget_ ), bytes_( exchange( other.bytes_, 0 ) )
+{}
+
+ReassemblyBudget::Lease& ReassemblyBudget::Lease::operator=( Lease&& other ) noexcept
+{
+  if ( this != &other ) {
+    shrink( bytes_ );
+    budget_ = other.budget_;
+    bytes_ = exchange( other.bytes_, 0 );
+  }
+  return *this;
+}
+
+void ReassemblyBudget::Lease::grow( uint64_t bytes )
+{
+  bytes_ += bytes;
+  if ( budget_ ) {
+    budget_->used_.fetch_add( bytes, memory_order_relaxed );
+  }
+}
+
+void ReassemblyBudget::Lease::shrink( uint64_t bytes )
+{
+  bytes_ -= bytes;
+  if ( budget_ ) {
+    budget_->used_.fetch_sub( bytes, memory_order_relaxed );
+  }
+}
+
+ReassemblyBudget& ReassemblyBudget::global()
+{
+  static ReassemblyBudget budget;
+  return budget;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// A memory budget for out-of-order data, shared by every Reassembler that charges it
+// (by default, all of them charge the process-wide global() budget).
+//
+// When an insert would take the budget over its limit, the inserting Reassembler prunes
+// its own farthest-ahead fragments first, as Linux prunes its out-of-order queue, and
+// refuses the new bytes if they are the farthest ahead. Pruned bytes are simply
+// retransmitted by the peer later, so the limit trades memory for retransmissions.
+class ReassemblyBudget
+{
+public:
+  explicit ReassemblyBudget( uint64_t limit = UINT64_MAX ) : limit_( limit ) {}
+
+  ReassemblyBudget( const ReassemblyBudget& other ) = delete;
+  ReassemblyBudget& operator=( const ReassemblyBudget& other ) = delete;
+
+  void set_limit( uint64_t limit ) { limit_.store( limit, std::memory_order_relaxed ); }
+  uint64_t limit() const { return limit_.load( std::memory_order_relaxed ); }
+  uint64_t used() const { return used_.load( std::memory_order_relaxed ); }
+  bool over_limit() const { return used() > limit(); }
+
+  uint64_t pruned_bytes() const { return pruned_bytes_.load( std::memory_order_relaxed ); }   // evicted once held
+  uint64_t refused_bytes() const { return refused_bytes_.load( std::memory_order_relaxed ); } // never held
+
+  void record_pruned( uint64_t bytes ) { pruned_bytes_.fetch_add( bytes, std::memory_order_relaxed ); }
+  void record_refused( uint64_t bytes ) { refused_bytes_.fetch_add( bytes, std::memory_order_relaxed ); }
+
+  // The share of a budget held by one Reassembler; gives back whatever it still holds when destroyed
+  class Lease
+  {
+  public:
+    explicit Lease( ReassemblyBudget* budget ) : budget_( budget ) {}
+    ~Lease() { shrink( bytes_ ); }
+
+    Lease( const Lease& other ) = delete;
+    Lease& operator=( const Lease& other ) = delete;
+    Lease( Lease&& other ) noexcept;
+    Lease& operator=( Lease&& other ) noexcept;
+
+    void grow( uint64_t bytes );
+    void shrink( uint64_t bytes );
+
+    ReassemblyBudget* budget() const { return budget_; }
+    bool over_limit() const { return budget_ and budget_->over_limit(); }
+
+  private:
+    ReassemblyBudget* budget_;
+    uint64_t bytes_ {};
+  };
+
+  // The budget shared by every Reassembler that isn't given another one
+  static ReassemblyBudget& global();
+
+private:
+  std::atomic<uint64_t> limit_;
+  std::atomic<uint64_t> used_ {};
+  std::atomic<uint64_t> pruned_bytes_ {};
+  std::atomic<uint64_t> refused_bytes_ {};
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "address.hh"
+#include "reassembler.hh"
 #include "wrapping_integers.hh"
 
 #include <cstddef>
@@ -11,15 +12,64 @@
 class TCPConfig
 {
 public:
-  static constexpr size_t DEFAULT_CAPACITY = 64000; //!< Default capacity
-  static constexpr size_t MAX_PAYLOAD_SIZE = 1000;  //!< Conservative max payload size for real Internet
-  static constexpr uint16_t TIMEOUT_DFLT = 1000;    //!< Default re-transmit timeout is 1 second
-  static constexpr unsigned MAX_RETX_ATTEMPTS = 8;  //!< Maximum re-transmit attempts before giving up
-
-  uint16_t rt_timeout = TIMEOUT_DFLT;      //!< Initial value of the retransmission timeout, in milliseconds
-  size_t recv_capacity = DEFAULT_CAPACITY; //!< Receive capacity, in bytes
-  size_t send_capacity = DEFAULT_CAPACITY; //!< Sender capacity, in bytes
-  Wrap32 isn { 137 };                      //!< Default initial sequence number
+  static constexpr size_t DEFAULT_CAPACITY = 64000;     //!< Default capacity
+  static constexpr size_t MAX_PAYLOAD_SIZE = 1000;      //!< Conservative max payload size for real Internet
+  static constexpr uint16_t TIMEOUT_DFLT = 1000;        //!< Default re-transmit timeout is 1 second
+  static constexpr uint16_t MIN_TIMEOUT_DFLT = 200;     //!< Default floor on the adaptive re-transmit timeout
+  static constexpr uint32_t MAX_TIMEOUT_DFLT = 60000;   //!< Default cap on the (backed-off) re-transmit timeout
+  static constexpr unsigned MAX_RETX_ATTEMPTS = 8;      //!< Maximum re-transmit attempts before giving up
+  static constexpr uint16_t DEFAULT_PEER_MSS = 536;     //!< MSS assumed when the peer's SYN has no MSS option
+  static constexpr uint8_t MAX_WINDOW_SHIFT = 14;       //!< Largest window-scale shift allowed by RFC 7323
+  static constexpr uint16_t TIMESTAMPS_LEN = 12;        //!< Header bytes the timestamps option takes in a segment
+  static constexpr uint16_t AUTOCORK_DFLT = 200;        //!< Default cap on how long a cork holds back a partial segment
+  static constexpr uint16_t ACK_DELAY_DFLT = 40;        //!< Default longest delay of an ACK for in-order data
+
+  //! Congestion control algorithm used by the TCPSender
+  enum class CongestionControl : uint8_t
+  {
+    None,    //!< Limited only by the receiver's window
+    NewReno, //!< Slow start and congestion avoidance (RFC 5681) with byte counting (RFC 3465)
+    BBR,     //!< Paces at the measured bottleneck bandwidth, cwnd near two bandwidth-delay products
+    DCTCP,   //!< NewReno that cuts cwnd in proportion to the share of ECN-marked data (RFC 8257); implies ecn
+  };
+
+  uint16_t rt_timeout = TIMEOUT_DFLT;           //!< Initial value of the retransmission timeout, in milliseconds
+  uint16_t min_rt_timeout = MIN_TIMEOUT_DFLT;   //!< Lower bound on the RTT-derived retransmission timeout
+  uint32_t max_rt_timeout = MAX_TIMEOUT_DFLT;   //!< Upper bound on the retransmission timeout, in milliseconds
+  size_t recv_capacity = DEFAULT_CAPACITY;      //!< Receive capacity, in bytes
+  size_t send_capacity = DEFAULT_CAPACITY;      //!< Sender capacity, in bytes
+  //! Out-of-order fragments the Reassembler may hold
+  size_t max_fragments = Reassembler::DEFAULT_MAX_FRAGMENTS;
+  uint16_t mss = MAX_PAYLOAD_SIZE;              //!< Largest payload per segment, announced in the SYN
+  bool mtu_probing = false;                     //!< Start at MAX_PAYLOAD_SIZE and probe up to mss (RFC 4821)
+  bool window_reassembly = false;               //!< Reassemble in place in the receive buffer (no fragments)
+  bool sack = true;                             //!< Negotiate and use selective acknowledgments (RFC 2018)
+  bool window_scale = true;                     //!< Negotiate window scaling so windows can exceed 64 KB
+  bool timestamps = true;                       //!< Negotiate timestamps: an RTT sample per ACK, Eifel undo
+  bool frto = false;                            //!< Without timestamps, detect spurious timeouts with F-RTO
+  bool rack = true;                             //!< Detect losses by send time and probe tail losses (RACK-TLP)
+  bool ecn = false;                             //!< Negotiate ECN: routers mark instead of drop (RFC 3168)
+  bool nodelay = false;                         //!< Send partial segments at once instead of using Nagle's algorithm
+  uint16_t autocork_timeout = AUTOCORK_DFLT;    //!< Longest a cork holds back a partial segment, in milliseconds
+  uint16_t ack_delay = ACK_DELAY_DFLT;          //!< Longest an ACK waits for a second segment (0: ACK every one)
+  bool pacing = false;                          //!< Space segments out in time instead of sending bursts
+  uint64_t pacing_rate = 0;                     //!< Fixed pacing rate, bytes/s (0: derived from cwnd/SRTT)
+  Wrap32 isn { 137 };                           //!< Default initial sequence number
+
+  CongestionControl congestion_control = CongestionControl::NewReno; //!< Congestion control algorithm
+
+  //! Is ECN requested, either directly or by a congestion control algorithm that depends on it?
+  bool ecn_enabled() const { return ecn or congestion_control == CongestionControl::DCTCP; }
+
+  //! Smallest window-scale shift that lets the 16-bit window field cover recv_capacity
+  uint8_t recv_window_shift() const
+  {
+    uint8_t shift = 0;
+    while ( shift < MAX_WINDOW_SHIFT and ( recv_capacity >> shift ) > UINT16_MAX ) {
+      shift++;
+    }
+    return shift;
+  }
 };
 
 //! Config for classes derived from FdAdapter
@@ -31,4 +81,5 @@ public:
 
   uint16_t loss_rate_dn = 0; //!< Downlink loss rate (for LossyFdAdapter)
   uint16_t loss_rate_up = 0; //!< Uplink loss rate (for LossyFdAdapter)
+  uint16_t path_mtu = 0;     //!< Drop outbound datagrams larger than this (for LossyFdAdapter); 0 for no limit
 };
@@ -1,7 +1,9 @@
 #include "tcp_minnow_socket.hh"
 
+#include "buffer_pool.hh"
 #include "exception.hh"
 #include "parser.hh"
+#include "reassembly_budget.hh"
 #include "tun.hh"
 
 #include <cstddef>
@@ -105,10 +107,7 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP( const TCPConfig& config )
     _thread_data,
     Direction::In,
     [&] {
-      std::string data;
-      data.resize( _tcp->outbound_writer().available_capacity() );
-      _thread_data.read( data );
-      _tcp->outbound_writer().push( move( data ) );
+      _thread_data.read_into( _tcp->outbound_writer() );
 
       if ( _thread_data.eof() ) {
         _tcp->outbound_writer().close();
@@ -147,9 +146,10 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP( const TCPConfig& config )
       // the pipe, handling the possibility of a partial
       // write (i.e., only pop what was actually written).
       if ( inbound.bytes_buffered() ) {
-        const std::string_view buffer = inbound.peek();
-        const auto bytes_written = _thread_data.write( buffer );
+        inbound.peek( _inbound_views );
+        const auto bytes_written = _thread_data.write( _inbound_views );
         inbound.pop( bytes_written );
+        _tcp->update_window( [&]( auto x ) { _datagram_adapter.write( x ); } );
       }
 
       if ( inbound.is_finished() or inbound.has_error() ) {
@@ -286,6 +286,20 @@ void TCPMinnowSocket<AdaptT>::_tcp_main()
       std::cerr << "DEBUG: minnow TCP connection finished "
                 << ( _tcp->inbound_reader().has_error() ? "uncleanly.\n" : "cleanly.\n" );
     }
+
+    // debugging output:
+    const auto& pool = BufferPool::local().stats();
+    std::cerr << "DEBUG: minnow buffer pool: " << pool.hits << " hits, " << pool.misses << " misses, "
+              << pool.recycled << " recycled, " << pool.dropped << " dropped.\n";
+    const auto& sender = _tcp->sender().stats();
+    std::cerr << "DEBUG: minnow sender: " << sender.fast_retransmits << " fast retransmits ("
+              << sender.rack_losses << " RACK losses), " << sender.tail_loss_probes << " tail loss probes, "
+              << sender.timeouts << " timeouts (" << sender.spurious_timeouts << " spurious), "
+              << sender.ecn_reductions << " ECN reductions, MSS " << _tcp->sender().MSS() << " ("
+              << sender.mtu_probes << " MTU probes, " << sender.mtu_probes_lost << " lost).\n";
+    const auto& budget = ReassemblyBudget::global();
+    std::cerr << "DEBUG: minnow reassembly budget: " << budget.pruned_bytes() << " bytes pruned, "
+              << budget.refused_bytes() << " bytes refused.\n";
     _tcp.reset();
   } catch ( const std::exception& e ) {
     std::cerr << "Exception in TCPConnection runner thread: " << e.what() << "\n";
@@ -69,6 +69,9 @@ optional<TCPMessage> TCPOverIPv4Adapter::unwrap_tcp_in_ip( const InternetDatagra
     return {};
   }
 
+  // the ECN codepoint is part of the IP header, but the TCP receiver is the one that echoes it
+  tcp_seg.message.sender.CE = ip_dgram.header.ecn() == IPv4Header::ECN_CE;
+
   return tcp_seg.message;
 }
 
@@ -85,7 +88,10 @@ InternetDatagram TCPOverIPv4Adapter::wrap_tcp_in_ip( const TCPMessage& msg )
   InternetDatagram ip_dgram;
   ip_dgram.header.src = config().source.ipv4_numeric();
   ip_dgram.header.dst = config().destination.ipv4_numeric();
-  ip_dgram.header.len = ip_dgram.header.hlen * 4 + 20 /* tcp header len */ + seg.message.sender.payload.size();
+  if ( msg.sender.ECT ) {
+    ip_dgram.header.set_ecn( IPv4Header::ECN_ECT0 );
+  }
+  ip_dgram.header.len = ip_dgram.header.hlen * 4 + seg.header_length() + seg.message.sender.payload.size();
 
   // set payload, calculating TCP checksum using information from IP header
   seg.compute_checksum( ip_dgram.header.pseudo_checksum() );
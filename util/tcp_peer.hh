@@ -7,6 +7,8 @@
 #include "tcp_sender.hh"
 #include "tcp_sender_message.hh"
 
+#include <algorithm>
+#include <cstdint>
 #include <functional>
 #include <optional>
 
@@ -28,10 +30,37 @@ public:
 
   /* Passthrough methods */
   void push( const TransmitFunction& transmit ) { sender_.push( make_send( transmit ) ); }
+
+  /* Cork: hold back partial segments until uncork(), a full segment's worth of data, or cfg.autocork_timeout */
+  void cork() { sender_.set_corked( true ); }
+  void uncork( const TransmitFunction& transmit )
+  {
+    sender_.set_corked( false );
+    push( transmit );
+  }
   void tick( uint64_t t, const TransmitFunction& transmit )
   {
     cumulative_time_ += t;
     sender_.tick( t, make_send( transmit ) );
+
+    // A delayed ACK that no outgoing data picked up in the meantime goes out on its own.
+    if ( ack_deadline_.has_value() and cumulative_time_ >= ack_deadline_.value() ) {
+      send( sender_.make_empty_message(), transmit );
+    }
+    update_window( transmit );
+  }
+
+  /* The application read from inbound_reader(): if that reopened the window by at least one MSS or half the
+     buffer, tell the peer now, rather than leave it waiting on a closed window until its timer fires */
+  void update_window( const TransmitFunction& transmit )
+  {
+    if ( not has_ackno() or receiver_.writer().is_closed() ) {
+      return;
+    }
+    const uint64_t step = std::min<uint64_t>( cfg_.mss, cfg_.recv_capacity / 2 );
+    if ( window_edge() >= advertised_edge_ + std::max<uint64_t>( step, 1 ) ) {
+      send( sender_.make_empty_message(), transmit );
+    }
   }
   bool has_ackno() const { return receiver_.send().ackno.has_value(); }
 
@@ -56,9 +85,6 @@ public:
     // Record time in case this peer has to linger after streams finish.
     time_of_last_receipt_ = cumulative_time_;
 
-    // If SenderMessage occupies a sequence number, make sure to reply.
-    need_send_ |= ( msg.sender.sequence_length() > 0 );
-
     // If SenderMessage is a "keep-alive" (with intentionally invalid seqno), make sure to reply.
     // (N.B. orthodox TCP rules require a reply on any unacceptable segment.)
     const auto our_ackno = receiver_.send().ackno;
@@ -69,11 +95,49 @@ public:
       linger_after_streams_finish_ = false;
     }
 
+    // The peer's SYN says how large a segment it is willing to receive, whether it stamps its segments,
+    // and whether it understands ECN.
+    if ( msg.sender.SYN ) {
+      sender_.set_peer_MSS( msg.sender.MSS );
+      sender_.set_peer_timestamps( msg.sender.timestamp.has_value() );
+      sender_.set_peer_ECN( msg.sender.ECN );
+    }
+
+    // Remember the timestamp to echo: the newest one from a segment that starts at or before the ackno we
+    // last sent (RFC 7323 section 4.3), so that an ACK after a hole is filled times the segment that filled it.
+    if ( msg.sender.timestamp.has_value()
+         and ( not our_ackno.has_value() or not seqno_after( msg.sender.seqno, our_ackno.value() ) )
+         and ( not ts_recent_.has_value()
+               or static_cast<int32_t>( msg.sender.timestamp.value() - ts_recent_.value() ) >= 0 ) ) {
+      ts_recent_ = msg.sender.timestamp;
+    }
+
     // Give incoming TCPSenderMessage to receiver.
+    const bool syn = msg.sender.SYN;
+    const auto peer_window_scale = msg.sender.window_scale;
+    const bool occupies_seqnos = msg.sender.sequence_length() > 0;
+    const uint64_t payload_size = msg.sender.payload.size();
+    const bool in_order = not syn and our_ackno.has_value() and msg.sender.seqno == our_ackno.value();
+    const bool fin = msg.sender.FIN;
+    const bool had_holes = receiver_.reassembler().bytes_pending() > 0;
+    const bool ece = receiver_.send().ECE;
     receiver_.receive( std::move( msg.sender ) );
 
-    // Give incoming TCPReceiverMessage to sender.
+    // If SenderMessage occupies a sequence number, make sure to reply. Anything out of order (or filling a
+    // hole), a FIN, and a change in the ECN echo that DCTCP's estimate depends on are ACKed right away.
+    if ( occupies_seqnos ) {
+      schedule_ack( payload_size,
+                    not in_order or fin or had_holes or receiver_.reassembler().bytes_pending() > 0
+                      or receiver_.send().ECE != ece );
+    }
+
+    // Give incoming TCPReceiverMessage to sender, then send whatever the ACK or window update allows.
+    // The window in a SYN is never scaled, so scaling starts with the peer's next segment.
     sender_.receive( msg.receiver );
+    if ( syn ) {
+      sender_.set_peer_window_scale( peer_window_scale );
+    }
+    push( transmit );
 
     // Send reply if needed.
     if ( need_send_ ) {
@@ -87,16 +151,77 @@ public:
 
 private:
   TCPConfig cfg_;
-  TCPSender sender_ { ByteStream { cfg_.send_capacity }, cfg_.isn, cfg_.rt_timeout };
-  TCPReceiver receiver_ { Reassembler { ByteStream { cfg_.recv_capacity } } };
+  TCPSender sender_ { ByteStream { cfg_.send_capacity }, cfg_ };
+  TCPReceiver receiver_ {
+    Reassembler { ByteStream { cfg_.recv_capacity },
+                  cfg_.max_fragments,
+                  cfg_.window_reassembly ? Reassembler::Storage::Window : Reassembler::Storage::Fragments },
+    cfg_.sack,
+    cfg_.window_scale ? std::optional { cfg_.recv_window_shift() } : std::nullopt,
+    ecn_echo( cfg_ ),
+    cfg_.mss };
+
+  // DCTCP needs to know which segments were marked, not just that some were
+  static TCPReceiver::ECNEcho ecn_echo( const TCPConfig& cfg )
+  {
+    if ( not cfg.ecn_enabled() ) {
+      return TCPReceiver::ECNEcho::None;
+    }
+    return cfg.congestion_control == TCPConfig::CongestionControl::DCTCP ? TCPReceiver::ECNEcho::PerSegment
+                                                                         : TCPReceiver::ECNEcho::UntilCWR;
+  }
 
   bool need_send_ {};
 
+  // Delayed ACKs (RFC 1122 section 4.2.3.2, RFC 5681 section 4.2): in-order data is ACKed every second
+  // full-sized segment, or once ack_delay has passed, unless outgoing data carries the ACK first.
+  // The connection's first segments are ACKed one by one, so as not to slow the peer's slow start.
+  static constexpr uint8_t QUICK_ACKS = 16;
+  uint8_t quick_acks_ { QUICK_ACKS };
+  uint64_t rcv_mss_ {};       // largest payload seen from the peer: our estimate of its segment size
+  uint64_t unacked_bytes_ {}; // payload received since our last ACK
+  std::optional<uint64_t> ack_deadline_ {};
+
+  void schedule_ack( uint64_t payload_size, bool immediate )
+  {
+    rcv_mss_ = std::max( rcv_mss_, payload_size );
+    unacked_bytes_ += payload_size;
+    if ( not immediate and quick_acks_ > 0 ) {
+      quick_acks_--;
+      immediate = true;
+    }
+    if ( immediate or cfg_.ack_delay == 0 or unacked_bytes_ >= 2 * rcv_mss_ ) {
+      need_send_ = true;
+    } else if ( not ack_deadline_.has_value() ) {
+      ack_deadline_ = cumulative_time_ + cfg_.ack_delay;
+    }
+  }
+
+  // Most recent timestamp received from the peer, echoed in every stamped segment we send
+  std::optional<uint32_t> ts_recent_ {};
+
+  // Right edge of the receive window (a stream index), and its value in the last segment we sent
+  uint64_t window_edge() const { return receiver_.writer().bytes_pushed() + receiver_.window(); }
+  uint64_t advertised_edge_ {};
+
+  // Does sequence number `a` come after `b` (modulo 2^32)?
+  static bool seqno_after( Wrap32 a, Wrap32 b ) { return a.unwrap( b, 1UL << 32 ) > 1UL << 32; }
+
   void send( const TCPSenderMessage& sender_message, const TransmitFunction& transmit )
   {
     TCPMessage msg { sender_message, receiver_.send() };
+    if ( sender_message.SYN ) {
+      // The window in a SYN is never scaled (RFC 7323 section 2.2).
+      msg.receiver.window_size = std::min<uint64_t>( receiver_.writer().available_capacity(), UINT16_MAX );
+    }
+    if ( sender_message.timestamp.has_value() and msg.receiver.ackno.has_value() ) {
+      msg.receiver.timestamp_echo = ts_recent_.value_or( 0 );
+    }
     transmit( std::move( msg ) );
+    advertised_edge_ = window_edge();
     need_send_ = false;
+    unacked_bytes_ = 0;
+    ack_deadline_.reset();
   }
 
   bool linger_after_streams_finish_ { true }; // one peer may need to linger to make sure all closure conditions met
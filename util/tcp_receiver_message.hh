@@ -2,7 +2,11 @@
 
 #include "wrapping_integers.hh"
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <optional>
+#include <span>
 
 /*
  * The TCPReceiverMessage structure contains the information sent from a TCP receiver to its sender.
@@ -17,11 +21,38 @@
  *    the <cstdint> header).
  *
  * 3) The RST (reset) flag. If set, the stream has suffered an error and the connection should be aborted.
+ *
+ * Once both sides have permitted it, the receiver may also report up to MAX_SACK_BLOCKS blocks of
+ * out-of-order data it is holding beyond the ackno (the SACK option, RFC 2018), the block containing
+ * the most recently received segment first.
+ *
+ * If timestamps are in use, an ACK also echoes the timestamp of the segment that most recently
+ * advanced the ackno (the TSecr half of the timestamps option, RFC 7323).
+ *
+ * If both sides negotiated ECN, the ECE flag echoes Congestion Experienced marks back to the sender
+ * (RFC 3168): until the sender answers with CWR, or, for DCTCP, exactly for the segments that were marked.
  */
 
+struct SackBlock
+{
+  Wrap32 begin { 0 }; // first sequence number held
+  Wrap32 end { 0 };   // one past the last sequence number held
+};
+
 struct TCPReceiverMessage
 {
+  static constexpr size_t MAX_SACK_BLOCKS = 4; // as many as fit in the TCP options space
+
   std::optional<Wrap32> ackno {};
   uint16_t window_size {};
   bool RST {};
+
+  std::array<SackBlock, MAX_SACK_BLOCKS> sack_blocks {};
+  uint8_t num_sack_blocks {};
+
+  std::optional<uint32_t> timestamp_echo {};
+
+  bool ECE {};
+
+  std::span<const SackBlock> sack() const { return { sack_blocks.data(), num_sack_blocks }; }
 };
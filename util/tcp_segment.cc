@@ -2,12 +2,34 @@
 #include "checksum.hh"
 #include "wrapping_integers.hh"
 
+#include <algorithm>
 #include <cstddef>
 
 static constexpr uint32_t TCPHeaderMinLen = 5; // 32-bit words
 
+// TCP option kinds (RFC 9293, RFC 2018, RFC 7323)
+enum TCPOptionKind : uint8_t
+{
+  OptEnd = 0,
+  OptNOP = 1,
+  OptMSS = 2,
+  OptWindowScale = 3,
+  OptSACKPermitted = 4,
+  OptSACK = 5,
+  OptTimestamps = 8,
+};
+
+static constexpr uint8_t SACKBlockLen = 8; // two 32-bit sequence numbers
+
 using namespace std;
 
+// The option space holds 40 bytes: next to the timestamps option, only three SACK blocks fit
+static size_t sack_blocks_sent( const TCPMessage& message )
+{
+  const size_t limit = message.sender.timestamp.has_value() ? 3 : TCPReceiverMessage::MAX_SACK_BLOCKS;
+  return min<size_t>( message.receiver.num_sack_blocks, limit );
+}
+
 void TCPSegment::parse( Parser& parser, uint32_t datagram_layer_pseudo_checksum )
 {
   /* verify checksum */
@@ -43,19 +65,118 @@ void TCPSegment::parse( Parser& parser, uint32_t datagram_layer_pseudo_checksum
   message.sender.SYN = octet & 0b0000'0010;
   message.sender.FIN = octet & 0b0000'0001;
 
+  // On a SYN, ECE and CWR negotiate ECN: both set on the SYN, ECE alone on the SYN-ACK (RFC 3168)
+  const bool ece = octet & 0b0100'0000;
+  const bool cwr = octet & 0b1000'0000;
+  if ( message.sender.SYN ) {
+    message.sender.ECN = ece and cwr != message.receiver.ackno.has_value();
+  } else {
+    message.receiver.ECE = ece;
+    message.sender.CWR = cwr;
+  }
+
   parser.integer( message.receiver.window_size );
   parser.integer( udinfo.cksum );
   parser.integer( raw16 ); // urgent pointer
 
-  // skip any options or anything extra in the header
   if ( data_offset < TCPHeaderMinLen ) {
     parser.set_error();
+    return;
   }
-  parser.remove_prefix( data_offset * 4 - TCPHeaderMinLen * 4 );
+  parse_options( parser, data_offset * 4 - TCPHeaderMinLen * 4 );
 
   parser.all_remaining( message.sender.payload );
 }
 
+void TCPSegment::parse_options( Parser& parser, size_t len )
+{
+  while ( len > 0 and not parser.has_error() ) {
+    uint8_t kind {};
+    parser.integer( kind );
+    len--;
+    if ( kind == OptEnd ) {
+      break;
+    }
+    if ( kind == OptNOP ) {
+      continue;
+    }
+
+    uint8_t option_len {};
+    if ( len > 0 ) {
+      parser.integer( option_len );
+      len--;
+    }
+    if ( option_len < 2 or option_len - 2U > len ) {
+      break; // malformed option: ignore the rest of the option space
+    }
+    size_t body_len = option_len - 2U;
+    len -= body_len;
+
+    if ( kind == OptMSS and body_len == 2 ) {
+      parser.integer( message.sender.MSS );
+      body_len = 0;
+    } else if ( kind == OptWindowScale and body_len == 1 ) {
+      uint8_t shift {};
+      parser.integer( shift );
+      message.sender.window_scale = shift;
+      body_len = 0;
+    } else if ( kind == OptTimestamps and body_len == 8 ) {
+      uint32_t tsval {};
+      uint32_t tsecr {};
+      parser.integer( tsval );
+      parser.integer( tsecr );
+      message.sender.timestamp = tsval;
+      if ( message.receiver.ackno.has_value() ) {
+        message.receiver.timestamp_echo = tsecr; // TSecr is only meaningful with the ACK bit
+      }
+      body_len = 0;
+    } else if ( kind == OptSACKPermitted and body_len == 0 ) {
+      message.sender.SACK_permitted = true;
+    } else if ( kind == OptSACK and body_len % SACKBlockLen == 0 ) {
+      auto& receiver = message.receiver;
+      for ( ; body_len > 0; body_len -= SACKBlockLen ) {
+        uint32_t begin {};
+        uint32_t end {};
+        parser.integer( begin );
+        parser.integer( end );
+        if ( receiver.num_sack_blocks < TCPReceiverMessage::MAX_SACK_BLOCKS ) {
+          receiver.sack_blocks.at( receiver.num_sack_blocks++ ) = { Wrap32 { begin }, Wrap32 { end } };
+        }
+      }
+    }
+    parser.remove_prefix( body_len ); // options we don't understand
+  }
+
+  // skip padding and anything extra in the header
+  parser.remove_prefix( len );
+}
+
+size_t TCPSegment::options_length( const TCPMessage& message )
+{
+  size_t len = 0;
+  if ( message.sender.SYN and message.sender.MSS ) {
+    len += 4; // MSS
+  }
+  if ( message.sender.SYN and message.sender.window_scale.has_value() ) {
+    len += 4; // NOP, window scale
+  }
+  if ( message.sender.SYN and message.sender.SACK_permitted ) {
+    len += 4; // NOP, NOP, SACK-permitted
+  }
+  if ( message.sender.timestamp.has_value() ) {
+    len += 12; // NOP, NOP, timestamps
+  }
+  if ( sack_blocks_sent( message ) > 0 ) {
+    len += 4 + SACKBlockLen * sack_blocks_sent( message ); // NOP, NOP, SACK header, blocks
+  }
+  return len;
+}
+
+size_t TCPSegment::header_length( const TCPMessage& message )
+{
+  return TCPHeaderMinLen * 4 + options_length( message );
+}
+
 class Wrap32Serializable : public Wrap32
 {
 public:
@@ -68,14 +189,56 @@ void TCPSegment::serialize( Serializer& serializer ) const
   serializer.integer( udinfo.dst_port );
   serializer.integer( Wrap32Serializable { message.sender.seqno }.raw_value() );
   serializer.integer( Wrap32Serializable { message.receiver.ackno.value_or( Wrap32 { 0 } ) }.raw_value() );
-  serializer.integer( uint8_t { TCPHeaderMinLen << 4 } ); // data offset
+  serializer.integer( static_cast<uint8_t>( ( header_length() / 4 ) << 4 ) ); // data offset
   const bool reset = message.sender.RST or message.receiver.RST;
-  const uint8_t flags = ( message.receiver.ackno.has_value() ? 0b0001'0000U : 0 ) | ( reset ? 0b0000'0100U : 0 )
-                        | ( message.sender.SYN ? 0b0000'0010U : 0 ) | ( message.sender.FIN ? 0b0000'0001U : 0 );
+  const bool syn = message.sender.SYN;
+  const bool ece = syn ? message.sender.ECN : message.receiver.ECE;
+  const bool cwr = syn ? message.sender.ECN and not message.receiver.ackno.has_value() : message.sender.CWR;
+  const uint8_t flags = ( cwr ? 0b1000'0000U : 0 ) | ( ece ? 0b0100'0000U : 0 )
+                        | ( message.receiver.ackno.has_value() ? 0b0001'0000U : 0 ) | ( reset ? 0b0000'0100U : 0 )
+                        | ( syn ? 0b0000'0010U : 0 ) | ( message.sender.FIN ? 0b0000'0001U : 0 );
   serializer.integer( flags );
   serializer.integer( message.receiver.window_size );
   serializer.integer( udinfo.cksum );
   serializer.integer( uint16_t { 0 } ); // urgent pointer
+
+  // options, each padded with NOPs to a 32-bit boundary
+  if ( message.sender.SYN and message.sender.MSS ) {
+    serializer.integer( uint8_t { OptMSS } );
+    serializer.integer( uint8_t { 4 } );
+    serializer.integer( message.sender.MSS );
+  }
+  if ( message.sender.SYN and message.sender.window_scale.has_value() ) {
+    serializer.integer( uint8_t { OptNOP } );
+    serializer.integer( uint8_t { OptWindowScale } );
+    serializer.integer( uint8_t { 3 } );
+    serializer.integer( message.sender.window_scale.value() );
+  }
+  if ( message.sender.SYN and message.sender.SACK_permitted ) {
+    serializer.integer( uint8_t { OptNOP } );
+    serializer.integer( uint8_t { OptNOP } );
+    serializer.integer( uint8_t { OptSACKPermitted } );
+    serializer.integer( uint8_t { 2 } );
+  }
+  if ( message.sender.timestamp.has_value() ) {
+    serializer.integer( uint8_t { OptNOP } );
+    serializer.integer( uint8_t { OptNOP } );
+    serializer.integer( uint8_t { OptTimestamps } );
+    serializer.integer( uint8_t { 10 } );
+    serializer.integer( message.sender.timestamp.value() );
+    serializer.integer( message.receiver.timestamp_echo.value_or( 0 ) );
+  }
+  if ( sack_blocks_sent( message ) > 0 ) {
+    serializer.integer( uint8_t { OptNOP } );
+    serializer.integer( uint8_t { OptNOP } );
+    serializer.integer( uint8_t { OptSACK } );
+    serializer.integer( static_cast<uint8_t>( 2 + SACKBlockLen * sack_blocks_sent( message ) ) );
+    for ( const SackBlock& block : message.receiver.sack().first( sack_blocks_sent( message ) ) ) {
+      serializer.integer( Wrap32Serializable { block.begin }.raw_value() );
+      serializer.integer( Wrap32Serializable { block.end }.raw_value() );
+    }
+  }
+
   serializer.buffer( message.sender.payload );
 }
 
@@ -19,5 +19,13 @@ struct TCPSegment
   void parse( Parser& parser, uint32_t datagram_layer_pseudo_checksum );
   void serialize( Serializer& serializer ) const;
 
+  // Length of the serialized TCP header, including options, in bytes
+  size_t header_length() const { return header_length( message ); }
+  static size_t header_length( const TCPMessage& message );
+
   void compute_checksum( uint32_t datagram_layer_pseudo_checksum );
+
+private:
+  void parse_options( Parser& parser, size_t len );
+  static size_t options_length( const TCPMessage& message );
 };
@@ -2,6 +2,8 @@
 
 #include "wrapping_integers.hh"
 
+#include <cstdint>
+#include <optional>
 #include <string>
 
 /*
@@ -20,6 +22,22 @@
  * 4) The FIN flag. If set, the payload represents the ending of the byte stream.
  *
  * 5) The RST (reset) flag. If set, the stream has suffered an error and the connection should be aborted.
+ *
+ * It can also carry the SACK-permitted option (RFC 2018), which is only meaningful on a SYN: the sender of
+ * the SYN can make use of selective acknowledgments from its peer.
+ *
+ * A SYN may also announce the largest payload its sender is willing to receive in one segment (the MSS
+ * option; zero means the option is absent), and the shift count its receiver will apply to the window
+ * field of every later segment (the window-scale option, RFC 7323).
+ *
+ * If both SYNs carried one, every segment is stamped with its sender's clock (the TSval half of the
+ * timestamps option, RFC 7323). The receiver echoes it back so the sender can time each ACK.
+ *
+ * Explicit Congestion Notification (RFC 3168): a SYN with the ECN flag asks to use ECN (the ECE and CWR
+ * bits on the wire). Once both SYNs did, data segments travel in datagrams marked ECN-capable (ECT), a
+ * router may mark such a datagram Congestion Experienced (CE) instead of dropping it, and the sender sets
+ * CWR on the first new segment after it has reduced its window in response. ECT and CE belong to the IP
+ * header: the adapter copies ECT into the datagram it builds and sets CE from the datagram it received.
  */
 
 struct TCPSenderMessage
@@ -32,6 +50,16 @@ struct TCPSenderMessage
 
   bool RST {};
 
+  bool SACK_permitted {};
+  uint16_t MSS {};
+  std::optional<uint8_t> window_scale {};
+  std::optional<uint32_t> timestamp {};
+
+  bool ECN {}; // on a SYN: ECN setup
+  bool CWR {}; // congestion window reduced
+  bool ECT {}; // IP: send in an ECN-capable datagram
+  bool CE {};  // IP: arrived marked Congestion Experienced
+
   // How many sequence numbers does this segment use?
   size_t sequence_length() const { return SYN + payload.size() + FIN; }
 };
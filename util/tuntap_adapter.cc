@@ -1,4 +1,5 @@
 #include "tuntap_adapter.hh"
+#include "buffer_pool.hh"
 #include "parser.hh"
 
 using namespace std;
@@ -10,8 +11,14 @@ optional<TCPMessage> TCPOverIPv4OverTunFdAdapter::read()
   _tun.read( strs );
 
   InternetDatagram ip_dgram;
-  const vector<string> buffers = { strs.at( 0 ), strs.at( 1 ) };
-  if ( parse( ip_dgram, buffers ) ) {
+  const bool parsed = parse( ip_dgram, strs );
+
+  // the parser keeps its own copy, so the read buffer can go back to the pool right away
+  if ( not strs.empty() ) {
+    BufferPool::local().release( move( strs.back() ) );
+  }
+
+  if ( parsed ) {
     return unwrap_tcp_in_ip( ip_dgram );
   }
   return {};